@@ -0,0 +1,5 @@
+DELETE FROM `rbac_permissions` WHERE `id` = 836;
+INSERT INTO `rbac_permissions` (`id`, `name`) VALUES (836, 'Command: debug mapupdates');
+
+DELETE FROM `rbac_linked_permissions` WHERE `id` = 192 AND `linkedId` = 836;
+INSERT INTO `rbac_linked_permissions` (`id`, `linkedId`) VALUES (192, 836);
@@ -0,0 +1,5 @@
+DELETE FROM `rbac_permissions` WHERE `id` = 837;
+INSERT INTO `rbac_permissions` (`id`, `name`) VALUES (837, 'Command: debug opcodestats');
+
+DELETE FROM `rbac_linked_permissions` WHERE `id` = 192 AND `linkedId` = 837;
+INSERT INTO `rbac_linked_permissions` (`id`, `linkedId`) VALUES (192, 837);
@@ -0,0 +1,5 @@
+DELETE FROM `rbac_permissions` WHERE `id` = 838;
+INSERT INTO `rbac_permissions` (`id`, `name`) VALUES (838, 'Command: list respawns');
+
+DELETE FROM `rbac_linked_permissions` WHERE `id` = 196 AND `linkedId` = 838;
+INSERT INTO `rbac_linked_permissions` (`id`, `linkedId`) VALUES (196, 838);
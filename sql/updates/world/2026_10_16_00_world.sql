@@ -0,0 +1,2 @@
+DELETE FROM `command` WHERE `name` = 'debug mapupdates';
+INSERT INTO `command` (`name`, `permission`, `help`) VALUES ('debug mapupdates', 836, 'Syntax: .debug mapupdates [mapId]\nLists the effective update interval and the update cost of all loaded maps and instances');
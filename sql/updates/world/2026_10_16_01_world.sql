@@ -0,0 +1,2 @@
+DELETE FROM `command` WHERE `name` = 'debug opcodestats';
+INSERT INTO `command` (`name`, `permission`, `help`) VALUES ('debug opcodestats', 837, 'Syntax: .debug opcodestats [count|reset]\nShows the busiest client packet handlers (count, bytes, total, p50/p99 and max time) and the most sent opcodes since the last reset or dump, split by packet processing. "reset" clears the statistics.');
@@ -0,0 +1,8 @@
+DELETE FROM `command` WHERE `name` = 'list respawns';
+INSERT INTO `command` (`name`, `permission`, `help`) VALUES ('list respawns', 838, 'Syntax: .list respawns [zoneId]\nLists the dead creatures and gameobjects of your map that are waiting to respawn in the given zone, your current zone by default, soonest first.');
+
+DELETE FROM `trinity_string` WHERE `entry` IN (1191, 1192, 1193);
+INSERT INTO `trinity_string` (`entry`,`content_default`) VALUES
+(1191,'%u pending respawns in zone %u:'),
+(1192,'%s respawns in %s'),
+(1193,'%s respawns on the next map update');
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+/// Bounded lock free queue between exactly one producer and one consumer, neither side blocks or allocates.
+/// A side may move to another thread as long as the hand over itself synchronizes, only one thread may use it at a time.
+template <typename T, std::size_t Capacity>
+class SPSCQueue
+{
+    static_assert(Capacity && !(Capacity & (Capacity - 1)), "SPSCQueue capacity must be a power of two");
+
+public:
+    SPSCQueue() : _head(0), _tail(0) { }
+
+    SPSCQueue(SPSCQueue const& right) = delete;
+    SPSCQueue& operator=(SPSCQueue const& right) = delete;
+
+    //! Producer side, returns false if the queue is full.
+    bool Push(T const& value)
+    {
+        std::size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == Capacity)
+            return false;
+
+        _items[tail & (Capacity - 1)] = value;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    //! Consumer side, copies the oldest item without removing it.
+    bool Peek(T& value) const
+    {
+        std::size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire))
+            return false;
+
+        value = _items[head & (Capacity - 1)];
+        return true;
+    }
+
+    //! Consumer side, removes the item returned by Peek.
+    void Pop()
+    {
+        _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    //! Consumer side.
+    bool Pop(T& value)
+    {
+        if (!Peek(value))
+            return false;
+
+        Pop();
+        return true;
+    }
+
+    bool Empty() const
+    {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+private:
+    // head and tail on cache lines of their own, each side only writes its own index
+    std::atomic<std::size_t> _head;
+    char _headPadding[64 - sizeof(std::atomic<std::size_t>)];
+    std::atomic<std::size_t> _tail;
+    char _tailPadding[64 - sizeof(std::atomic<std::size_t>)];
+    T _items[Capacity];
+};
+
+#endif
@@ -727,6 +727,9 @@ enum RBACPermissions
     RBAC_PERM_COMMAND_TICKET_RESET_SUGGESTION                = 833,
     RBAC_PERM_COMMAND_GO_QUEST                               = 834,
     RBAC_PERM_COMMAND_DEBUG_LOADCELLS                        = 835,
+    RBAC_PERM_COMMAND_DEBUG_MAPUPDATES                       = 836,
+    RBAC_PERM_COMMAND_DEBUG_OPCODESTATS                      = 837,
+    RBAC_PERM_COMMAND_LIST_RESPAWNS                          = 838,
 
     // custom permissions 1000+
     RBAC_PERM_MAX
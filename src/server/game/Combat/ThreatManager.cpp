@@ -94,7 +94,14 @@ HostileReference::HostileReference(Unit* refUnit, ThreatManager* threatManager,
 {
     iThreat = threat;
     iTempThreatModifier = 0.0f;
-    link(refUnit, threatManager);
+    {
+        // creatures of two parallel regions may start hating the same unit
+        std::unique_lock<std::recursive_mutex> lock;
+        if (Map* map = refUnit->FindMap())
+            lock = map->LockRegions();
+
+        link(refUnit, threatManager);
+    }
     iUnitGuid = refUnit->GetGUID();
     iOnline = true;
     iAccessible = true;
@@ -254,7 +261,14 @@ void ThreatContainer::clearReferences()
 {
     for (ThreatContainer::StorageType::const_iterator i = iThreatList.begin(); i != iThreatList.end(); ++i)
     {
-        (*i)->unlink();
+        {
+            // the reference leaves the hostile list of its target, which a parallel region may be linking to
+            std::unique_lock<std::recursive_mutex> lock;
+            if (Map* map = (*i)->getTarget() ? (*i)->getTarget()->FindMap() : nullptr)
+                lock = map->LockRegions();
+
+            (*i)->unlink();
+        }
         delete (*i);
     }
 
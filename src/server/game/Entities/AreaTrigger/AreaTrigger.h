@@ -41,6 +41,8 @@ class AreaTrigger : public WorldObject, public GridObject<AreaTrigger>
         void Delay(int32 delaytime) { SetDuration(GetDuration() - delaytime); }
 
     protected:
+        void UpdatePositionIndex() override { SetGridPosition(GetPositionX(), GetPositionY()); }
+
         int32 _duration;
 };
 #endif
@@ -79,6 +79,9 @@ class Corpse : public WorldObject, public GridObject<Corpse>
 
         bool IsExpired(time_t t) const;
 
+    protected:
+        void UpdatePositionIndex() override { SetGridPosition(GetPositionX(), GetPositionY()); }
+
     private:
         CorpseType m_type;
         time_t m_time;
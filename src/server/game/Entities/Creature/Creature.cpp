@@ -181,9 +181,9 @@ bool ForcedDespawnDelayEvent::Execute(uint64 /*e_time*/, uint32 /*p_time*/)
 
 Creature::Creature(bool isWorldObject): Unit(isWorldObject), MapObject(),
 m_groupLootTimer(0), m_PlayerDamageReq(0),
-_pickpocketLootRestore(0), m_corpseRemoveTime(0), m_respawnTime(0),
+_pickpocketLootRestore(0), m_corpseRemoveTime(0), m_respawnTime(0), m_scheduledRespawnTime(0), m_respawnQueued(false),
 m_respawnDelay(300), m_corpseDelay(60), m_respawnradius(0.0f), m_combatPulseTime(0), m_combatPulseDelay(0), m_reactState(REACT_AGGRESSIVE),
-m_defaultMovementType(IDLE_MOTION_TYPE), m_spawnId(UI64LIT(0)), m_equipmentId(0), m_originalEquipmentId(0), m_AlreadyCallAssistance(false),
+m_hibernateTime(0), m_defaultMovementType(IDLE_MOTION_TYPE), m_spawnId(UI64LIT(0)), m_equipmentId(0), m_originalEquipmentId(0), m_AlreadyCallAssistance(false),
 m_AlreadySearchedAssistance(false), m_regenHealth(true), m_AI_locked(false), m_meleeDamageSchoolMask(SPELL_SCHOOL_MASK_NORMAL),
 m_originalEntry(0), m_homePosition(), m_transportHomePosition(), m_creatureInfo(NULL), m_creatureData(NULL), m_waypointID(0), m_path_id(0), m_formation(NULL)
 {
@@ -292,8 +292,13 @@ void Creature::RemoveCorpse(bool setSpawnTime)
 
     // Should get removed later, just keep "compatibility" with scripts
     if (setSpawnTime)
+    {
         m_respawnTime = time(NULL) + respawnDelay;
 
+        // setDeathState(DEAD) queued the respawn with the time set at death, which includes the corpse delay
+        ScheduleRespawn();
+    }
+
     float x, y, z, o;
     GetRespawnPosition(x, y, z, &o);
     SetHomePosition(x, y, z, o);
@@ -492,6 +497,17 @@ bool Creature::UpdateEntry(uint32 entry, CreatureData const* data /*= nullptr*/)
 
 void Creature::Update(uint32 diff)
 {
+    if (m_hibernateTime)
+    {
+        uint32 sleptTime = m_hibernateTime;
+        m_hibernateTime = 0;
+        WakeUp(sleptTime);
+
+        // replaying the whole sleep would fire every missed repeat of AI and script timers at once and
+        // run waypoints and splines ahead of the clients, they resume where they stopped instead
+        diff += std::min<uint32>(sleptTime, sWorld->getIntConfig(CONFIG_INTERVAL_MAPUPDATE));
+    }
+
     if (IsAIEnabled && TriggerJustRespawned)
     {
         TriggerJustRespawned = false;
@@ -513,30 +529,10 @@ void Creature::Update(uint32 diff)
             TC_LOG_ERROR("entities.unit", "Creature (%s) in wrong state: JUST_DEAD (1)", GetGUID().ToString().c_str());
             break;
         case DEAD:
-        {
-            time_t now = time(NULL);
-            if (m_respawnTime <= now)
-            {
-                bool allowed = IsAIEnabled ? AI()->CanRespawn() : true;     // First check if there are any scripts that object to us respawning
-                if (!allowed)                                               // Will be rechecked on next Update call
-                    break;
-
-                ObjectGuid dbtableHighGuid = ObjectGuid::Create<HighGuid::Creature>(GetMapId(), GetEntry(), m_spawnId);
-                time_t linkedRespawntime = GetMap()->GetLinkedRespawnTime(dbtableHighGuid);
-                if (!linkedRespawntime)             // Can respawn
-                    Respawn();
-                else                                // the master is dead
-                {
-                    ObjectGuid targetGuid = sObjectMgr->GetLinkedRespawnGuid(dbtableHighGuid);
-                    if (targetGuid == dbtableHighGuid) // if linking self, never respawn (check delayed to next day)
-                        SetRespawnTime(DAY);
-                    else
-                        m_respawnTime = (now > linkedRespawntime ? now : linkedRespawntime) + urand(5, MINUTE); // else copy time from master and add a little
-                    SaveRespawnTime(); // also save to DB immediately
-                }
-            }
+            // creatures owned by the map are respawned by Map::ProcessRespawns
+            if (IsSummon())
+                UpdateRespawn(time(NULL));
             break;
-        }
         case CORPSE:
         {
             Unit::Update(diff);
@@ -677,6 +673,34 @@ void Creature::Update(uint32 diff)
     sScriptMgr->OnCreatureUpdate(this, diff);
 }
 
+bool Creature::CanHibernate() const
+{
+    // anything a fight, a script or another unit may be waiting on keeps ticking
+    return IsAlive() && !IsInCombat() && !IsInEvadeMode() && !isActiveObject() && !IsSummon() &&
+        GetCharmerOrOwnerGUID().IsEmpty() && !GetVehicleKit() && !GetVehicle();
+}
+
+void Creature::WakeUp(uint32 sleptTime)
+{
+    if (!IsAlive() || IsInCombat() || IsInEvadeMode())
+        return;
+
+    // regeneration ticks missed while asleep, timers, auras, AI and movement are paused for the slept time
+    uint32 ticks = std::min<uint32>(sleptTime / CREATURE_REGEN_INTERVAL, CREATURE_HIBERNATION_MAX_REGEN_TICKS);
+    for (; ticks; --ticks)
+    {
+        RegenerateHealth();
+
+        if (HasFlag(UNIT_FIELD_FLAGS_2, UNIT_FLAG2_REGENERATE_POWER))
+        {
+            if (getPowerType() == POWER_ENERGY)
+                Regenerate(POWER_ENERGY);
+            else
+                RegenerateMana();
+        }
+    }
+}
+
 void Creature::RegenerateMana()
 {
     uint32 curValue = GetPower(POWER_MANA);
@@ -1331,6 +1355,7 @@ bool Creature::LoadCreatureFromDB(ObjectGuid::LowType spawnId, Map* map, bool ad
     if (m_respawnTime)                          // respawn on Update
     {
         m_deathState = DEAD;
+        ScheduleRespawn();
         if (CanFly())
         {
             float tz = map->GetHeight(GetPhaseMask(), data->posX, data->posY, data->posZ, false);
@@ -1607,6 +1632,8 @@ void Creature::setDeathState(DeathState s)
 
         Unit::setDeathState(CORPSE);
     }
+    else if (s == DEAD)
+        ScheduleRespawn();
     else if (s == JUST_RESPAWNED)
     {
         //if (IsPet())
@@ -1627,6 +1654,62 @@ void Creature::setDeathState(DeathState s)
     }
 }
 
+void Creature::UpdateRespawn(time_t now)
+{
+    m_respawnQueued = false;
+
+    if (m_respawnTime > now)
+    {
+        ScheduleRespawn();
+        return;
+    }
+
+    bool allowed = IsAIEnabled ? AI()->CanRespawn() : true;     // First check if there are any scripts that object to us respawning
+    if (!allowed)                                               // Will be rechecked on next map update
+    {
+        ScheduleRespawn();
+        return;
+    }
+
+    ObjectGuid dbtableHighGuid = ObjectGuid::Create<HighGuid::Creature>(GetMapId(), GetEntry(), m_spawnId);
+    time_t linkedRespawntime = GetMap()->GetLinkedRespawnTime(dbtableHighGuid);
+    if (!linkedRespawntime)             // Can respawn
+        Respawn();
+    else                                // the master is dead
+    {
+        ObjectGuid targetGuid = sObjectMgr->GetLinkedRespawnGuid(dbtableHighGuid);
+        if (targetGuid == dbtableHighGuid) // if linking self, never respawn (check delayed to next day)
+            SetRespawnTime(DAY);
+        else
+            m_respawnTime = (now > linkedRespawntime ? now : linkedRespawntime) + urand(5, MINUTE); // else copy time from master and add a little
+        SaveRespawnTime(); // also save to DB immediately
+        ScheduleRespawn();
+    }
+}
+
+void Creature::ScheduleRespawn()
+{
+    // summons are never respawned by their map, they poll in Update
+    if (IsSummon())
+        return;
+
+    if (m_respawnQueued && m_scheduledRespawnTime == m_respawnTime)
+        return;
+
+    m_respawnQueued = true;
+    m_scheduledRespawnTime = m_respawnTime;
+    GetMap()->ScheduleRespawn(GetGUID(), m_respawnTime);
+}
+
+void Creature::SetRespawnTime(uint32 respawn)
+{
+    m_respawnTime = respawn ? time(NULL) + respawn : 0;
+
+    // the queued entry may be later than the new time
+    if (m_deathState == DEAD)
+        ScheduleRespawn();
+}
+
 void Creature::Respawn(bool force)
 {
     DestroyForNearbyPlayers();
@@ -66,6 +66,7 @@ enum CreatureFlagsExtra
     CREATURE_FLAG_EXTRA_GUARD | CREATURE_FLAG_EXTRA_IGNORE_PATHFINDING)
 
 #define CREATURE_REGEN_INTERVAL 2 * IN_MILLISECONDS
+#define CREATURE_HIBERNATION_MAX_REGEN_TICKS 30
 
 #define MAX_KILL_CREDIT 2
 #define MAX_CREATURE_MODELS 4
@@ -485,6 +486,10 @@ class Creature : public Unit, public GridObject<Creature>, public MapObject
         ObjectGuid::LowType GetSpawnId() const { return m_spawnId; }
 
         void Update(uint32 time) override;                         // overwrited Unit::Update
+
+        // idle creatures in cells no player sees skip their updates, the next Update replays the slept time
+        bool CanHibernate() const;
+        void Hibernate(uint32 diff) { m_hibernateTime += diff; }
         void GetRespawnPosition(float &x, float &y, float &z, float* ori = nullptr, float* dist =nullptr) const;
 
         void SetCorpseDelay(uint32 delay) { m_corpseDelay = delay; }
@@ -628,8 +633,10 @@ class Creature : public Unit, public GridObject<Creature>, public MapObject
 
         time_t const& GetRespawnTime() const { return m_respawnTime; }
         time_t GetRespawnTimeEx() const;
-        void SetRespawnTime(uint32 respawn) { m_respawnTime = respawn ? time(NULL) + respawn : 0; }
+        void SetRespawnTime(uint32 respawn);
         void Respawn(bool force = false);
+        void UpdateRespawn(time_t now);
+        time_t GetScheduledRespawnTime() const { return m_scheduledRespawnTime; }
         void SaveRespawnTime() override;
 
         uint32 GetRespawnDelay() const { return m_respawnDelay; }
@@ -712,8 +719,12 @@ class Creature : public Unit, public GridObject<Creature>, public MapObject
         void ClearTextRepeatGroup(uint8 textGroup);
 
     protected:
+        void UpdatePositionIndex() override { SetGridPosition(GetPositionX(), GetPositionY()); }
+
         bool CreateFromProto(ObjectGuid::LowType guidlow, uint32 entry, CreatureData const* data = nullptr, uint32 vehId = 0);
         bool InitEntry(uint32 entry, CreatureData const* data = nullptr);
+        void ScheduleRespawn();
+        void WakeUp(uint32 sleptTime);
 
         // vendor items
         VendorItemCounts m_vendorItemCounts;
@@ -728,6 +739,8 @@ class Creature : public Unit, public GridObject<Creature>, public MapObject
         time_t _pickpocketLootRestore;
         time_t m_corpseRemoveTime;                          // (msecs)timer for death or corpse disappearance
         time_t m_respawnTime;                               // (secs) time of next respawn
+        time_t m_scheduledRespawnTime;                      // (secs) respawn time queued in the map
+        bool m_respawnQueued;
         uint32 m_respawnDelay;                              // (secs) delay between corpse disappearance and respawning
         uint32 m_corpseDelay;                               // (secs) delay between death and corpse disappearance
         float m_respawnradius;
@@ -738,6 +751,7 @@ class Creature : public Unit, public GridObject<Creature>, public MapObject
         void RegenerateMana();
         void RegenerateHealth();
         void Regenerate(Powers power);
+        uint32 m_hibernateTime;                             // (msecs) update time skipped while hibernating
         MovementGeneratorType m_defaultMovementType;
         ObjectGuid::LowType m_spawnId;                               ///< For new or temporary creatures is 0 for saved it is lowguid
         uint8 m_equipmentId;
@@ -59,6 +59,8 @@ class DynamicObject : public WorldObject, public GridObject<DynamicObject>, publ
         float GetRadius() const { return GetFloatValue(DYNAMICOBJECT_RADIUS); }
 
     protected:
+        void UpdatePositionIndex() override { SetGridPosition(GetPositionX(), GetPositionY()); }
+
         Aura* _aura;
         Aura* _removedAura;
         Unit* _caster;
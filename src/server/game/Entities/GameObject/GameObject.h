@@ -884,6 +884,7 @@ class GameObject : public WorldObject, public GridObject<GameObject>, public Map
         ~GameObject();
 
         void BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, Player* target) const override;
+        uint32 GetValuesUpdateCacheKey(Player* target) const override;
 
         void AddToWorld() override;
         void RemoveFromWorld() override;
@@ -1087,6 +1088,8 @@ class GameObject : public WorldObject, public GridObject<GameObject>, public Map
         void SetAnimKitId(uint16 animKitId, bool oneshot);
 
     protected:
+        void UpdatePositionIndex() override { SetGridPosition(GetPositionX(), GetPositionY()); }
+
         bool AIM_Initialize();
         GameObjectModel* CreateModel();
         void UpdateModel();                                 // updates model in case displayId were changed
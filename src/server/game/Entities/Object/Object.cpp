@@ -756,21 +756,37 @@ void Object::BuildValuesUpdate(uint8 updateType, ByteBuffer* data, Player* targe
     uint32 visibleFlag = GetUpdateFieldData(target, flags);
     ASSERT(flags);
 
-    for (uint16 index = 0; index < m_valuesCount; ++index)
+    BuildValuesUpdateMask(updateType, updateMask, flags, visibleFlag);
+    updateMask.ForEachSetBit([&](uint32 index)
     {
-        if (_fieldNotifyFlags & flags[index] ||
-            ((updateType == UPDATETYPE_VALUES ? _changesMask.GetBit(index) : m_uint32Values[index]) && (flags[index] & visibleFlag)))
-        {
-            updateMask.SetBit(index);
-            fieldBuffer << m_uint32Values[index];
-        }
-    }
+        fieldBuffer << m_uint32Values[index];
+    });
 
     *data << uint8(updateMask.GetBlockCount());
     updateMask.AppendToPacket(data);
     data->append(fieldBuffer);
 }
 
+void Object::BuildValuesUpdateMask(uint8 updateType, UpdateMask& updateMask, uint32 const* flags, uint32 visibleFlag) const
+{
+    UpdateFieldFlagMasks const& fieldMasks = UpdateFieldFlagMasks::Get(flags);
+
+    // start from every field the receiver may see and keep the changed ones, or the non zero ones for creation
+    fieldMasks.AddFields(updateMask, visibleFlag);
+    if (updateType == UPDATETYPE_VALUES)
+        updateMask &= _changesMask;
+    else
+    {
+        updateMask.ForEachSetBit([&](uint32 index)
+        {
+            if (!m_uint32Values[index])
+                updateMask.UnsetBit(index);
+        });
+    }
+
+    fieldMasks.AddFields(updateMask, _fieldNotifyFlags);
+}
+
 void Object::BuildDynamicValuesUpdate(uint8 updateType, ByteBuffer* data, Player* target) const
 {
     if (!target)
@@ -838,7 +854,7 @@ void Object::ClearUpdateMask(bool remove)
     }
 }
 
-void Object::BuildFieldsUpdate(Player* player, UpdateDataMapType& data_map) const
+void Object::BuildFieldsUpdate(Player* player, UpdateDataMapType& data_map, UpdateBlockCacheType* blockCache /*= nullptr*/) const
 {
     UpdateDataMapType::iterator iter = data_map.find(player);
 
@@ -849,7 +865,38 @@ void Object::BuildFieldsUpdate(Player* player, UpdateDataMapType& data_map) cons
         iter = p.first;
     }
 
-    BuildValuesUpdateBlockForPlayer(&iter->second, iter->first);
+    uint32 cacheKey = blockCache ? GetValuesUpdateCacheKey(player) : UPDATE_CACHE_KEY_NONE;
+    if (cacheKey == UPDATE_CACHE_KEY_NONE)
+    {
+        BuildValuesUpdateBlockForPlayer(&iter->second, iter->first);
+        return;
+    }
+
+    // build the block once for the first receiver of this visibility class, then reuse the bytes
+    UpdateBlockCacheType::iterator block = blockCache->find(cacheKey);
+    if (block == blockCache->end())
+    {
+        block = blockCache->emplace(cacheKey, ByteBuffer(500)).first;
+        ByteBuffer& buf = block->second;
+
+        buf << uint8(UPDATETYPE_VALUES);
+        buf << GetPackGUID();
+
+        BuildValuesUpdate(UPDATETYPE_VALUES, &buf, player);
+        BuildDynamicValuesUpdate(UPDATETYPE_VALUES, &buf, player);
+    }
+
+    iter->second.AddUpdateBlock(block->second);
+}
+
+uint32 Object::GetValuesUpdateCacheKey(Player* target) const
+{
+    // private fields are only ever sent to the object itself
+    if (target == this)
+        return UPDATE_CACHE_KEY_NONE;
+
+    uint32* flags = nullptr;
+    return GetUpdateFieldData(target, flags);
 }
 
 uint32 Object::GetUpdateFieldData(Player const* target, uint32*& flags) const
@@ -1514,6 +1561,7 @@ void WorldObject::RemoveFromWorld()
     if (!IsInWorld())
         return;
 
+    GetMap()->DeliverBroadcasts(this);
     DestroyForNearbyPlayers();
 
     Object::RemoveFromWorld();
@@ -2146,14 +2194,28 @@ void WorldObject::SendMessageToSet(WorldPacket const* data, bool self)
 
 void WorldObject::SendMessageToSetInRange(WorldPacket const* data, float dist, bool /*self*/)
 {
-    Trinity::MessageDistDeliverer notifier(this, data, dist);
-    VisitNearbyWorldObject(dist, notifier);
+    DeliverMessageToSet(data, dist, false, NULL);
 }
 
 void WorldObject::SendMessageToSet(WorldPacket const* data, Player const* skipped_rcvr)
 {
-    Trinity::MessageDistDeliverer notifier(this, data, GetVisibilityRange(), false, skipped_rcvr);
-    VisitNearbyWorldObject(GetVisibilityRange(), notifier);
+    DeliverMessageToSet(data, GetVisibilityRange(), false, skipped_rcvr);
+}
+
+void WorldObject::DeliverMessageToSet(WorldPacket const* data, float dist, bool ownTeamOnly, Player const* skippedRcvr)
+{
+    if (!IsInWorld())
+        return;
+
+    // the observers of the map only reach as far as its visibility range
+    if (GetMap()->IsBatchingBroadcasts() && dist <= GetMap()->GetVisibilityRange())
+    {
+        GetMap()->QueueBroadcast(this, data, dist, ownTeamOnly, skippedRcvr);
+        return;
+    }
+
+    Trinity::MessageDistDeliverer notifier(this, data, dist, ownTeamOnly, skippedRcvr);
+    VisitNearbyWorldObject(dist, notifier);
 }
 
 void WorldObject::SendObjectDeSpawnAnim(ObjectGuid guid)
@@ -2799,7 +2861,7 @@ void WorldObject::SetPhaseMask(uint32 newPhaseMask, bool update)
 
 bool WorldObject::HasInPhaseList(uint32 phase)
 {
-    return _phases.find(phase) != _phases.end();
+    return _phaseBits.Contains(phase);
 }
 
 // Updates Area based phases, does not remove phases from auras
@@ -2883,6 +2945,7 @@ bool WorldObject::SetInPhase(uint32 id, bool update, bool apply)
                 return false;
 
             _phases.insert(id);
+            _phaseBits.Rebuild(_phases);
         }
         else
         {
@@ -2898,6 +2961,7 @@ bool WorldObject::SetInPhase(uint32 id, bool update, bool apply)
                 return false;
 
             _phases.erase(id);
+            _phaseBits.Rebuild(_phases);
         }
     }
 
@@ -2924,6 +2988,7 @@ void WorldObject::CopyPhaseFrom(WorldObject* obj, bool update)
 void WorldObject::ClearPhases(bool update)
 {
     _phases.clear();
+    _phaseBits.Rebuild(_phases);
 
     RebuildTerrainSwaps();
 
@@ -2934,19 +2999,19 @@ void WorldObject::ClearPhases(bool update)
 bool WorldObject::IsInPhase(WorldObject const* obj) const
 {
     // PhaseId 169 is the default fallback phase
-    if (_phases.empty() && obj->GetPhases().empty())
+    if (_phaseBits.IsEmpty() && obj->_phaseBits.IsEmpty())
         return true;
 
-    if (_phases.empty() && obj->IsInPhase(DEFAULT_PHASE))
+    if (_phaseBits.IsEmpty() && obj->IsInPhase(DEFAULT_PHASE))
         return true;
 
-    if (obj->GetPhases().empty() && IsInPhase(DEFAULT_PHASE))
+    if (obj->_phaseBits.IsEmpty() && IsInPhase(DEFAULT_PHASE))
         return true;
 
     if (GetTypeId() == TYPEID_PLAYER && ToPlayer()->IsGameMaster())
         return true;
 
-    return Trinity::Containers::Intersects(_phases.begin(), _phases.end(), obj->GetPhases().begin(), obj->GetPhases().end());
+    return _phaseBits.Intersects(obj->_phaseBits);
 }
 
 void WorldObject::PlayDistanceSound(uint32 sound_id, Player* target /*= NULL*/)
@@ -2997,9 +3062,19 @@ void WorldObject::DestroyForNearbyPlayers()
 
 void WorldObject::UpdateObjectVisibility(bool /*forced*/)
 {
-    //updates object's visibility for nearby players
-    Trinity::VisibleChangesNotifier notifier(*this);
-    VisitNearbyWorldObject(GetVisibilityRange(), notifier);
+    if (!IsInWorld())
+        return;
+
+    // seen from further than the players' view point areas reach, visit the players around
+    if (GetVisibilityRange() > GetMap()->GetVisibilityRange())
+    {
+        Trinity::VisibleChangesNotifier notifier(*this);
+        VisitNearbyWorldObject(GetVisibilityRange(), notifier);
+        return;
+    }
+
+    //updates object's visibility for players observing its cell
+    GetMap()->UpdateVisibilityForObservers(this);
 }
 
 struct WorldObjectChangeAccumulator
@@ -3007,6 +3082,7 @@ struct WorldObjectChangeAccumulator
     UpdateDataMapType& i_updateDatas;
     WorldObject& i_object;
     GuidSet plr_list;
+    UpdateBlockCacheType i_blockCache;
     WorldObjectChangeAccumulator(WorldObject &obj, UpdateDataMapType &d) : i_updateDatas(d), i_object(obj) { }
     void Visit(PlayerMapType &m)
     {
@@ -3064,7 +3140,7 @@ struct WorldObjectChangeAccumulator
         // Only send update once to a player
         if (plr_list.find(player->GetGUID()) == plr_list.end() && player->HaveAtClient(&i_object))
         {
-            i_object.BuildFieldsUpdate(player, i_updateDatas);
+            i_object.BuildFieldsUpdate(player, i_updateDatas, &i_blockCache);
             plr_list.insert(player->GetGUID());
         }
     }
@@ -21,6 +21,7 @@
 
 #include "Common.h"
 #include "Position.h"
+#include "PhaseMask.h"
 #include "UpdateMask.h"
 #include "GridReference.h"
 #include "ObjectDefines.h"
@@ -91,6 +92,19 @@ class WorldPacket;
 class ZoneScript;
 
 typedef std::unordered_map<Player*, UpdateData> UpdateDataMapType;
+typedef std::unordered_map<uint32, ByteBuffer> UpdateBlockCacheType;
+
+// Receiver dependent parts of a values update, stored above the UF_FLAG_* visibility bits of a cache key
+enum ValuesUpdateCacheKeyFlags
+{
+    UPDATE_CACHE_KEY_NONE               = 0x000000,         // block is built for a single receiver and never shared
+    UPDATE_CACHE_KEY_GAMEMASTER         = 0x010000,
+    UPDATE_CACHE_KEY_SPELLCLICK_HIDDEN  = 0x020000,
+    UPDATE_CACHE_KEY_TAPPED_BY_VIEWER   = 0x040000,
+    UPDATE_CACHE_KEY_LOOT_DENIED        = 0x080000,
+    UPDATE_CACHE_KEY_TRACK_HIDDEN       = 0x100000,
+    UPDATE_CACHE_KEY_QUEST_ACTIVE       = 0x200000
+};
 
 class Object
 {
@@ -180,7 +194,7 @@ class Object
         virtual bool hasQuest(uint32 /* quest_id */) const { return false; }
         virtual bool hasInvolvedQuest(uint32 /* quest_id */) const { return false; }
         virtual void BuildUpdate(UpdateDataMapType&) { }
-        void BuildFieldsUpdate(Player*, UpdateDataMapType &) const;
+        void BuildFieldsUpdate(Player*, UpdateDataMapType &, UpdateBlockCacheType* blockCache = nullptr) const;
 
         void SetFieldNotifyFlag(uint16 flag) { _fieldNotifyFlags |= flag; }
         void RemoveFieldNotifyFlag(uint16 flag) { _fieldNotifyFlags &= uint16(~flag); }
@@ -222,7 +236,10 @@ class Object
 
         void BuildMovementUpdate(ByteBuffer* data, uint32 flags) const;
         virtual void BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, Player* target) const;
+        void BuildValuesUpdateMask(uint8 updatetype, UpdateMask& updateMask, uint32 const* flags, uint32 visibleFlag) const;
         virtual void BuildDynamicValuesUpdate(uint8 updatetype, ByteBuffer* data, Player* target) const;
+        // receivers with equal keys get byte identical values update blocks
+        virtual uint32 GetValuesUpdateCacheKey(Player* target) const;
 
         uint16 m_objectType;
 
@@ -358,8 +375,15 @@ class GridObject
         virtual ~GridObject() { }
 
         bool IsInGrid() const { return _gridRef.isValid(); }
-        void AddToGrid(GridRefManager<T>& m) { ASSERT(!IsInGrid()); _gridRef.link(&m, (T*)this); }
+        void AddToGrid(GridRefManager<T>& m)
+        {
+            ASSERT(!IsInGrid());
+            _gridRef.link(&m, (T*)this);
+            _gridRef.SetPosition(((T*)this)->GetPositionX(), ((T*)this)->GetPositionY());
+        }
         void RemoveFromGrid() { ASSERT(IsInGrid()); _gridRef.unlink(); }
+    protected:
+        void SetGridPosition(float x, float y) { if (IsInGrid()) _gridRef.SetPosition(x, y); }
     private:
         GridReference<T> _gridRef;
 };
@@ -431,6 +455,13 @@ class WorldObject : public Object, public WorldLocation
 
         virtual void RemoveFromWorld() override;
 
+        // shadow Position::Relocate so the position index of the owning grid cell follows every move
+        void Relocate(float x, float y) { WorldLocation::Relocate(x, y); UpdatePositionIndex(); }
+        void Relocate(float x, float y, float z) { WorldLocation::Relocate(x, y, z); UpdatePositionIndex(); }
+        void Relocate(float x, float y, float z, float orientation) { WorldLocation::Relocate(x, y, z, orientation); UpdatePositionIndex(); }
+        void Relocate(Position const& pos) { WorldLocation::Relocate(pos); UpdatePositionIndex(); }
+        void Relocate(Position const* pos) { WorldLocation::Relocate(pos); UpdatePositionIndex(); }
+
         void GetNearPoint2D(float &x, float &y, float distance, float absAngle) const;
         void GetNearPoint(WorldObject const* searcher, float &x, float &y, float &z, float searcher_size, float distance2d, float absAngle) const;
         void GetClosePoint(float &x, float &y, float &z, float size, float distance2d = 0, float angle = 0) const;
@@ -459,7 +490,7 @@ class WorldObject : public Object, public WorldLocation
         void RebuildWorldMapAreaSwaps();
         bool HasInPhaseList(uint32 phase);
         uint32 GetPhaseMask() const { return m_phaseMask; }
-        bool IsInPhase(uint32 phase) const { return _phases.find(phase) != _phases.end(); }
+        bool IsInPhase(uint32 phase) const { return _phaseBits.Contains(phase); }
         bool IsInPhase(WorldObject const* obj) const;
         bool IsInTerrainSwap(uint32 terrainSwap) const { return _terrainSwaps.find(terrainSwap) != _terrainSwaps.end(); }
         std::set<uint32> const& GetPhases() const { return _phases; }
@@ -635,6 +666,12 @@ class WorldObject : public Object, public WorldLocation
         void SetLocationMapId(uint32 _mapId) { m_mapId = _mapId; }
         void SetLocationInstanceId(uint32 _instanceId) { m_InstanceId = _instanceId; }
 
+        // grid objects push their new position into the owning cell's position index
+        virtual void UpdatePositionIndex() { }
+
+        // queued on the map while it updates, delivered to the players around right away otherwise
+        void DeliverMessageToSet(WorldPacket const* data, float dist, bool ownTeamOnly, Player const* skippedRcvr);
+
         virtual bool IsNeverVisible() const { return !IsInWorld(); }
         virtual bool IsAlwaysVisibleFor(WorldObject const* /*seer*/) const { return false; }
         virtual bool IsInvisibleDueToDespawn() const { return false; }
@@ -647,6 +684,7 @@ class WorldObject : public Object, public WorldLocation
         uint32 m_InstanceId;                                // in map copy with instance id
         uint32 m_phaseMask;                                 // in area phase state
         std::set<uint32> _phases;
+        PhaseMask _phaseBits;                               // same content as _phases, used for the hot membership and intersection tests
         std::set<uint32> _terrainSwaps;
         std::set<uint32> _worldMapAreaSwaps;
         int32 _dbPhase;
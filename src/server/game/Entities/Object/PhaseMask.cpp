@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PhaseMask.h"
+
+void PhaseMask::Rebuild(std::set<uint32> const& phases)
+{
+    _overflow.clear();
+
+    if (phases.empty())
+    {
+        _firstWord = 0;
+        _wordCount = 0;
+        return;
+    }
+
+    // std::set is ordered, first and last element bound the window
+    _firstWord = *phases.begin() / 64;
+    _wordCount = *phases.rbegin() / 64 - _firstWord + 1;
+
+    uint64* words = _inline;
+    if (_wordCount > PHASE_MASK_INLINE_WORDS)
+    {
+        _overflow.resize(_wordCount);
+        words = _overflow.data();
+    }
+
+    std::fill(words, words + _wordCount, UI64LIT(0));
+    for (uint32 phaseId : phases)
+        words[phaseId / 64 - _firstWord] |= UI64LIT(1) << (phaseId % 64);
+}
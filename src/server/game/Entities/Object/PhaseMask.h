@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PhaseMask_h__
+#define PhaseMask_h__
+
+#include "Define.h"
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#define PHASE_MASK_INLINE_WORDS 2
+
+// Bitset over phase ids, kept as a window of 64 bit words starting at the word of the lowest phase.
+// Phases of a single object are usually close to each other, so the window fits inline
+// and membership or intersection tests are a handful of AND instructions.
+class PhaseMask
+{
+    public:
+        PhaseMask() : _firstWord(0), _wordCount(0) { }
+
+        void Rebuild(std::set<uint32> const& phases);
+
+        bool IsEmpty() const { return _wordCount == 0; }
+
+        bool Contains(uint32 phaseId) const
+        {
+            uint32 word = phaseId / 64;
+            if (word < _firstWord || word >= _firstWord + _wordCount)
+                return false;
+
+            return (GetWords()[word - _firstWord] & (UI64LIT(1) << (phaseId % 64))) != 0;
+        }
+
+        bool Intersects(PhaseMask const& other) const
+        {
+            uint32 begin = std::max(_firstWord, other._firstWord);
+            uint32 end = std::min(_firstWord + _wordCount, other._firstWord + other._wordCount);
+            uint64 const* words = GetWords();
+            uint64 const* otherWords = other.GetWords();
+            for (uint32 i = begin; i < end; ++i)
+                if (words[i - _firstWord] & otherWords[i - other._firstWord])
+                    return true;
+
+            return false;
+        }
+
+    private:
+        uint64 const* GetWords() const { return _wordCount > PHASE_MASK_INLINE_WORDS ? _overflow.data() : _inline; }
+
+        uint32 _firstWord;
+        uint32 _wordCount;
+        uint64 _inline[PHASE_MASK_INLINE_WORDS];
+        std::vector<uint64> _overflow;                      // only used when the phases span more than the inline words
+};
+
+#endif // PhaseMask_h__
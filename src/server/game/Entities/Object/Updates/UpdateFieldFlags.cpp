@@ -15,6 +15,7 @@
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "Common.h"
 #include "UpdateFieldFlags.h"
 
 uint32 ItemUpdateFieldFlags[CONTAINER_END] =
@@ -4066,3 +4067,50 @@ uint32 ConversationDynamicUpdateFieldFlags[CONVERSATION_DYNAMIC_END] =
     UF_FLAG_0x100,                                          // CONVERSATION_DYNAMIC_FIELD_LINES
 };
 
+UpdateFieldFlagMasks::UpdateFieldFlagMasks(uint32 const* flags, uint32 count)
+{
+    for (uint32 bit = 0; bit < MAX_UF_FLAG_BITS; ++bit)
+        _masks[bit].SetCount(count);
+
+    for (uint32 index = 0; index < count; ++index)
+        for (uint32 bit = 0; bit < MAX_UF_FLAG_BITS; ++bit)
+            if (flags[index] & (1 << bit))
+                _masks[bit].SetBit(index);
+}
+
+void UpdateFieldFlagMasks::AddFields(UpdateMask& mask, uint32 flagMask) const
+{
+    for (uint32 bit = 0; bit < MAX_UF_FLAG_BITS; ++bit)
+        if (flagMask & (1 << bit))
+            mask |= _masks[bit];
+}
+
+UpdateFieldFlagMasks const& UpdateFieldFlagMasks::Get(uint32 const* flags)
+{
+    static UpdateFieldFlagMasks const itemMasks(ItemUpdateFieldFlags, CONTAINER_END);
+    static UpdateFieldFlagMasks const unitMasks(UnitUpdateFieldFlags, PLAYER_END);
+    static UpdateFieldFlagMasks const gameObjectMasks(GameObjectUpdateFieldFlags, GAMEOBJECT_END);
+    static UpdateFieldFlagMasks const dynamicObjectMasks(DynamicObjectUpdateFieldFlags, DYNAMICOBJECT_END);
+    static UpdateFieldFlagMasks const corpseMasks(CorpseUpdateFieldFlags, CORPSE_END);
+    static UpdateFieldFlagMasks const areaTriggerMasks(AreaTriggerUpdateFieldFlags, AREATRIGGER_END);
+    static UpdateFieldFlagMasks const sceneObjectMasks(SceneObjectUpdateFieldFlags, SCENEOBJECT_END);
+    static UpdateFieldFlagMasks const conversationMasks(ConversationUpdateFieldFlags, CONVERSATION_END);
+
+    if (flags == ItemUpdateFieldFlags)
+        return itemMasks;
+    if (flags == UnitUpdateFieldFlags)
+        return unitMasks;
+    if (flags == GameObjectUpdateFieldFlags)
+        return gameObjectMasks;
+    if (flags == DynamicObjectUpdateFieldFlags)
+        return dynamicObjectMasks;
+    if (flags == CorpseUpdateFieldFlags)
+        return corpseMasks;
+    if (flags == AreaTriggerUpdateFieldFlags)
+        return areaTriggerMasks;
+    if (flags == SceneObjectUpdateFieldFlags)
+        return sceneObjectMasks;
+
+    ASSERT(flags == ConversationUpdateFieldFlags);
+    return conversationMasks;
+}
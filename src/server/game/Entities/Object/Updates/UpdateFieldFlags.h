@@ -19,6 +19,7 @@
 #define _UPDATEFIELDFLAGS_H
 
 #include "UpdateFields.h"
+#include "UpdateMask.h"
 #include "Define.h"
 
 enum UpdatefieldFlags
@@ -37,6 +38,8 @@ enum UpdatefieldFlags
     UF_FLAG_URGENT_SELF_ONLY    = 0x400
 };
 
+#define MAX_UF_FLAG_BITS 11
+
 extern uint32 ItemUpdateFieldFlags[CONTAINER_END];
 extern uint32 ItemDynamicUpdateFieldFlags[CONTAINER_DYNAMIC_END];
 extern uint32 UnitUpdateFieldFlags[PLAYER_END];
@@ -50,4 +53,20 @@ extern uint32 SceneObjectUpdateFieldFlags[SCENEOBJECT_END];
 extern uint32 ConversationUpdateFieldFlags[CONVERSATION_END];
 extern uint32 ConversationDynamicUpdateFieldFlags[CONVERSATION_DYNAMIC_END];
 
+/// Packed masks of the fields carrying each UF_FLAG_* bit of one update field flags table
+class UpdateFieldFlagMasks
+{
+    public:
+        UpdateFieldFlagMasks(uint32 const* flags, uint32 count);
+
+        /// Sets in mask every field that carries any flag of flagMask, up to the field count of mask
+        void AddFields(UpdateMask& mask, uint32 flagMask) const;
+
+        /// Masks for one of the *UpdateFieldFlags tables above, built on first use
+        static UpdateFieldFlagMasks const& Get(uint32 const* flags);
+
+    private:
+        UpdateMask _masks[MAX_UF_FLAG_BITS];
+};
+
 #endif // _UPDATEFIELDFLAGS_H
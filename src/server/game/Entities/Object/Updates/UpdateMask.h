@@ -34,72 +34,85 @@ class UpdateMask
             CLIENT_UPDATE_MASK_BITS = sizeof(ClientUpdateMaskType) * 8,
         };
 
-        UpdateMask() : _fieldCount(0), _blockCount(0), _bits(NULL) { }
+        UpdateMask() : _fieldCount(0), _blockCount(0), _blocks(NULL) { }
 
-        UpdateMask(UpdateMask const& right) : _bits(NULL)
+        UpdateMask(UpdateMask const& right) : _blocks(NULL)
         {
             SetCount(right.GetCount());
-            memcpy(_bits, right._bits, sizeof(uint8) * _blockCount * 32);
+            memcpy(_blocks, right._blocks, sizeof(ClientUpdateMaskType) * _blockCount);
         }
 
-        ~UpdateMask() { delete[] _bits; }
+        ~UpdateMask() { delete[] _blocks; }
 
-        void SetBit(uint32 index) { _bits[index] = 1; }
-        void UnsetBit(uint32 index) { _bits[index] = 0; }
-        bool GetBit(uint32 index) const { return _bits[index] != 0; }
+        void SetBit(uint32 index) { _blocks[index / CLIENT_UPDATE_MASK_BITS] |= ClientUpdateMaskType(1) << (index % CLIENT_UPDATE_MASK_BITS); }
+        void UnsetBit(uint32 index) { _blocks[index / CLIENT_UPDATE_MASK_BITS] &= ~(ClientUpdateMaskType(1) << (index % CLIENT_UPDATE_MASK_BITS)); }
+        bool GetBit(uint32 index) const { return (_blocks[index / CLIENT_UPDATE_MASK_BITS] & (ClientUpdateMaskType(1) << (index % CLIENT_UPDATE_MASK_BITS))) != 0; }
 
+        /// Bits are stored in the same layout the client reads them, so blocks are written as they are
         void AppendToPacket(ByteBuffer* data)
         {
             for (uint32 i = 0; i < GetBlockCount(); ++i)
-            {
-                ClientUpdateMaskType maskPart = 0;
-                for (uint32 j = 0; j < CLIENT_UPDATE_MASK_BITS; ++j)
-                    if (_bits[CLIENT_UPDATE_MASK_BITS * i + j])
-                        maskPart |= 1 << j;
-
-                *data << maskPart;
-            }
+                *data << _blocks[i];
         }
 
         uint32 GetBlockCount() const { return _blockCount; }
         uint32 GetCount() const { return _fieldCount; }
 
+        ClientUpdateMaskType GetBlock(uint32 index) const { return _blocks[index]; }
+        void SetBlock(uint32 index, ClientUpdateMaskType block) { _blocks[index] = block; }
+
         void SetCount(uint32 valuesCount)
         {
-            delete[] _bits;
+            delete[] _blocks;
 
             _fieldCount = valuesCount;
             _blockCount = (valuesCount + CLIENT_UPDATE_MASK_BITS - 1) / CLIENT_UPDATE_MASK_BITS;
 
             if (!valuesCount)
             {
-                _bits = nullptr;
+                _blocks = nullptr;
                 return;
             }
 
-            _bits = new uint8[_blockCount * CLIENT_UPDATE_MASK_BITS];
-            memset(_bits, 0, sizeof(uint8) * _blockCount * CLIENT_UPDATE_MASK_BITS);
+            _blocks = new ClientUpdateMaskType[_blockCount];
+            memset(_blocks, 0, sizeof(ClientUpdateMaskType) * _blockCount);
         }
 
         void AddBlock()
         {
-            uint8* curr = _bits;
+            ClientUpdateMaskType* curr = _blocks;
             _fieldCount += CLIENT_UPDATE_MASK_BITS;
             ++_blockCount;
 
-            _bits = new uint8[_blockCount * CLIENT_UPDATE_MASK_BITS];
-            memset(&_bits[(_blockCount - 1) * CLIENT_UPDATE_MASK_BITS], 0, CLIENT_UPDATE_MASK_BITS);
+            _blocks = new ClientUpdateMaskType[_blockCount];
+            _blocks[_blockCount - 1] = 0;
             if (curr)
             {
-                memcpy(_bits, curr, sizeof(uint8) * (_blockCount - 1) * CLIENT_UPDATE_MASK_BITS);
+                memcpy(_blocks, curr, sizeof(ClientUpdateMaskType) * (_blockCount - 1));
                 delete[] curr;
             }
         }
 
         void Clear()
         {
-            if (_bits)
-                memset(_bits, 0, sizeof(uint8) * _blockCount * CLIENT_UPDATE_MASK_BITS);
+            if (_blocks)
+                memset(_blocks, 0, sizeof(ClientUpdateMaskType) * _blockCount);
+        }
+
+        /// Clears bits past the field count that whole block operations may have set
+        void TrimToCount()
+        {
+            if (uint32 tail = _fieldCount % CLIENT_UPDATE_MASK_BITS)
+                _blocks[_blockCount - 1] &= (ClientUpdateMaskType(1) << tail) - 1;
+        }
+
+        /// Calls f with the index of every set bit, in ascending order
+        template<class F>
+        void ForEachSetBit(F&& f) const
+        {
+            for (uint32 i = 0; i < _blockCount; ++i)
+                for (ClientUpdateMaskType block = _blocks[i]; block; block &= block - 1)
+                    f(i * CLIENT_UPDATE_MASK_BITS + LowestSetBit(block));
         }
 
         UpdateMask& operator=(UpdateMask const& right)
@@ -108,25 +121,30 @@ class UpdateMask
                 return *this;
 
             SetCount(right.GetCount());
-            memcpy(_bits, right._bits, sizeof(uint8) * _blockCount * CLIENT_UPDATE_MASK_BITS);
+            memcpy(_blocks, right._blocks, sizeof(ClientUpdateMaskType) * _blockCount);
             return *this;
         }
 
+        /// Block wise operators, fields past the end of the shorter mask are treated as unset
         UpdateMask& operator&=(UpdateMask const& right)
         {
-            ASSERT(right.GetCount() <= GetCount());
-            for (uint32 i = 0; i < _fieldCount; ++i)
-                _bits[i] &= right._bits[i];
+            uint32 blockCount = std::min(_blockCount, right._blockCount);
+            for (uint32 i = 0; i < blockCount; ++i)
+                _blocks[i] &= right._blocks[i];
+
+            for (uint32 i = blockCount; i < _blockCount; ++i)
+                _blocks[i] = 0;
 
             return *this;
         }
 
         UpdateMask& operator|=(UpdateMask const& right)
         {
-            ASSERT(right.GetCount() <= GetCount());
-            for (uint32 i = 0; i < _fieldCount; ++i)
-                _bits[i] |= right._bits[i];
+            uint32 blockCount = std::min(_blockCount, right._blockCount);
+            for (uint32 i = 0; i < blockCount; ++i)
+                _blocks[i] |= right._blocks[i];
 
+            TrimToCount();
             return *this;
         }
 
@@ -138,10 +156,21 @@ class UpdateMask
         }
 
     private:
+        // index of the lowest set bit of a non zero block: the isolated bit times a de Bruijn sequence puts a unique pattern in the top 5 bits
+        static uint32 LowestSetBit(ClientUpdateMaskType block)
+        {
+            static uint8 const DeBruijnBitIndex[32] =
+            {
+                0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+                31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+            };
+
+            return DeBruijnBitIndex[uint32((block & (~block + 1)) * 0x077CB531u) >> 27];
+        }
+
         uint32 _fieldCount;
         uint32 _blockCount;
-        uint8* _bits;
+        ClientUpdateMaskType* _blocks;
 };
 
 #endif
-
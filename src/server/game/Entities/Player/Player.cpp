@@ -307,6 +307,7 @@ Player::Player(WorldSession* session) : Unit(true)
     m_mover = this;
     m_movedPlayer = this;
     m_seer = this;
+    m_distantVisibilitySkips = 0;
 
     m_recallMap = 0;
     m_recallX = 0;
@@ -5834,8 +5835,7 @@ void Player::SendMessageToSetInRange(WorldPacket const* data, float dist, bool s
     if (self)
         GetSession()->SendPacket(data);
 
-    Trinity::MessageDistDeliverer notifier(this, data, dist);
-    VisitNearbyWorldObject(dist, notifier);
+    DeliverMessageToSet(data, dist, false, NULL);
 }
 
 void Player::SendMessageToSetInRange(WorldPacket const* data, float dist, bool self, bool own_team_only)
@@ -5843,8 +5843,7 @@ void Player::SendMessageToSetInRange(WorldPacket const* data, float dist, bool s
     if (self)
         GetSession()->SendPacket(data);
 
-    Trinity::MessageDistDeliverer notifier(this, data, dist, own_team_only);
-    VisitNearbyWorldObject(dist, notifier);
+    DeliverMessageToSet(data, dist, own_team_only, NULL);
 }
 
 void Player::SendMessageToSet(WorldPacket const* data, Player const* skipped_rcvr)
@@ -5854,8 +5853,7 @@ void Player::SendMessageToSet(WorldPacket const* data, Player const* skipped_rcv
 
     // we use World::GetMaxVisibleDistance() because i cannot see why not use a distance
     // update: replaced by GetMap()->GetVisibilityDistance()
-    Trinity::MessageDistDeliverer notifier(this, data, GetVisibilityRange(), false, skipped_rcvr);
-    VisitNearbyWorldObject(GetVisibilityRange(), notifier);
+    DeliverMessageToSet(data, GetVisibilityRange(), false, skipped_rcvr);
 }
 
 void Player::SendDirectMessage(WorldPacket const* data) const
@@ -21986,7 +21984,7 @@ void Player::UpdateObjectVisibility(bool forced)
         return;
 
     if (!forced)
-        AddToNotify(NOTIFY_VISIBILITY_CHANGED);
+        Unit::UpdateObjectVisibility(false);
     else
     {
         Unit::UpdateObjectVisibility(true);
@@ -21996,6 +21994,9 @@ void Player::UpdateObjectVisibility(bool forced)
 
 void Player::UpdateVisibilityForPlayer()
 {
+    if (IsInWorld())
+        GetMap()->UpdatePlayerInterest(this);
+
     // updates visibility of all objects around point of view for current player
     Trinity::VisibleNotifier notifier(*this);
     m_seer->VisitNearbyObject(GetSightRange(), notifier);
@@ -23885,13 +23886,22 @@ void Player::SetViewpoint(WorldObject* target, bool apply)
             static_cast<Unit*>(target)->RemovePlayerFromVision(this);
 
         //must immediately set seer back otherwise may crash
-        m_seer = this;
+        SetSeer(this);
 
         //WorldPacket data(SMSG_CLEAR_FAR_SIGHT_IMMEDIATE, 0);
         //GetSession()->SendPacket(&data);
     }
 }
 
+void Player::SetSeer(WorldObject* target)
+{
+    m_seer = target;
+
+    // the cells the player observes follow the view point, a far sight object may never move to trigger it
+    if (IsInWorld())
+        GetMap()->UpdatePlayerInterest(this);
+}
+
 WorldObject* Player::GetViewpoint() const
 {
     ObjectGuid guid = GetGuidValue(PLAYER_FARSIGHT);
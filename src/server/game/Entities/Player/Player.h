@@ -2254,7 +2254,7 @@ class Player : public Unit, public GridObject<Player>
 
         void SetMover(Unit* target);
 
-        void SetSeer(WorldObject* target) { m_seer = target; }
+        void SetSeer(WorldObject* target);
         void SetViewpoint(WorldObject* target, bool apply);
         WorldObject* GetViewpoint() const;
         void StopCastingCharm();
@@ -2285,6 +2285,8 @@ class Player : public Unit, public GridObject<Player>
 
         // currently visible objects at player client
         GuidUnorderedSet m_clientGUIDs;
+        // visibility updates since distant objects were last checked, see Visibility.LOD
+        uint32 m_distantVisibilitySkips;
 
         bool HaveAtClient(WorldObject const* u) const;
 
@@ -2482,6 +2484,8 @@ class Player : public Unit, public GridObject<Player>
         void SetAdvancedCombatLogging(bool enabled) { _advancedCombatLoggingEnabled = enabled; }
 
     protected:
+        void UpdatePositionIndex() override { SetGridPosition(GetPositionX(), GetPositionY()); }
+
         // Gamemaster whisper whitelist
         GuidList WhisperList;
         uint32 m_regenTimerCount;
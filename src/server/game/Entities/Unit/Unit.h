@@ -2230,6 +2230,7 @@ class Unit : public WorldObject
         explicit Unit (bool isWorldObject);
 
         void BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, Player* target) const override;
+        uint32 GetValuesUpdateCacheKey(Player* target) const override;
         void DestroyForPlayer(Player* target) const override;
 
         UnitAI* i_AI, *i_disabledAI;
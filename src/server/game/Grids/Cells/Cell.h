@@ -42,6 +42,12 @@ struct CellArea
         end_cell = high_bound;
     }
 
+    bool Contains(CellCoord const& p) const
+    {
+        return p.x_coord >= low_bound.x_coord && p.x_coord <= high_bound.x_coord &&
+            p.y_coord >= low_bound.y_coord && p.y_coord <= high_bound.y_coord;
+    }
+
     CellCoord low_bound;
     CellCoord high_bound;
 };
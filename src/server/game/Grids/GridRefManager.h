@@ -20,6 +20,11 @@
 #define _GRIDREFMANAGER
 
 #include "RefManager.h"
+#include <algorithm>
+#include <vector>
+
+// number of index slots tested per pass before the matching objects are touched
+#define GRID_POSITION_INDEX_BLOCK 32
 
 template<class OBJECT>
 class GridReference;
@@ -37,5 +42,83 @@ class GridRefManager : public RefManager<GridRefManager<OBJECT>, OBJECT>
         iterator end() { return iterator(NULL); }
         iterator rbegin() { return iterator(getLast()); }
         iterator rend() { return iterator(NULL); }
+
+        // Invalidate the references here, the dense arrays are already gone by the time ~RefManager runs
+        ~GridRefManager() { this->clearReferences(); }
+
+        // Contiguous copy of the linked sources, in no particular order. Only valid for scans that do not add or remove objects of this type in the cell.
+        std::vector<OBJECT*> const& GetObjects() const { return _objects; }
+
+        // Calls f(obj) for every object whose indexed position is within sqrt(rangeSq) of x, y (2d, exact, no object size).
+        // The distance test runs over the x/y arrays only, objects are dereferenced after they passed it.
+        template<class F>
+        void VisitInRange2d(float x, float y, float rangeSq, F&& f) const
+        {
+            uint32 const count = uint32(_objects.size());
+            for (uint32 base = 0; base < count; base += GRID_POSITION_INDEX_BLOCK)
+            {
+                uint32 const blockSize = std::min<uint32>(count - base, GRID_POSITION_INDEX_BLOCK);
+                float const* posX = &_posX[base];
+                float const* posY = &_posY[base];
+                bool inRange[GRID_POSITION_INDEX_BLOCK];
+
+                for (uint32 i = 0; i < blockSize; ++i)
+                {
+                    float dx = posX[i] - x;
+                    float dy = posY[i] - y;
+                    inRange[i] = dx * dx + dy * dy <= rangeSq;
+                }
+
+                for (uint32 i = 0; i < blockSize; ++i)
+                    if (inRange[i])
+                        f(_objects[base + i]);
+            }
+        }
+
+    private:
+        friend class GridReference<OBJECT>;
+
+        void AddDense(GridReference<OBJECT>* ref, OBJECT* obj, uint32& index)
+        {
+            index = uint32(_objects.size());
+            _objects.push_back(obj);
+            _refs.push_back(ref);
+            _posX.push_back(0.0f);
+            _posY.push_back(0.0f);
+        }
+
+        void RemoveDense(uint32 index);
+
+        void SetDensePosition(uint32 index, float x, float y)
+        {
+            _posX[index] = x;
+            _posY[index] = y;
+        }
+
+        std::vector<OBJECT*> _objects;
+        std::vector<GridReference<OBJECT>*> _refs;
+        std::vector<float> _posX;                           // structure of arrays position index, same order as _objects
+        std::vector<float> _posY;
 };
+
+#include "GridReference.h"
+
+template<class OBJECT>
+inline void GridRefManager<OBJECT>::RemoveDense(uint32 index)
+{
+    uint32 last = uint32(_objects.size()) - 1;
+    if (index != last)
+    {
+        _objects[index] = _objects[last];
+        _refs[index] = _refs[last];
+        _posX[index] = _posX[last];
+        _posY[index] = _posY[last];
+        _refs[index]->_denseIndex = index;
+    }
+
+    _objects.pop_back();
+    _refs.pop_back();
+    _posX.pop_back();
+    _posY.pop_back();
+}
 #endif
@@ -33,20 +33,32 @@ class GridReference : public Reference<GridRefManager<OBJECT>, OBJECT>
             // called from link()
             this->getTarget()->insertFirst(this);
             this->getTarget()->incSize();
+            this->getTarget()->AddDense(this, this->GetSource(), _denseIndex);
         }
         void targetObjectDestroyLink() override
         {
             // called from unlink()
-            if (this->isValid()) this->getTarget()->decSize();
+            if (this->isValid())
+            {
+                this->getTarget()->decSize();
+                this->getTarget()->RemoveDense(_denseIndex);
+            }
         }
         void sourceObjectDestroyLink() override
         {
             // called from invalidate()
             this->getTarget()->decSize();
+            this->getTarget()->RemoveDense(_denseIndex);
         }
     public:
-        GridReference() : Reference<GridRefManager<OBJECT>, OBJECT>() { }
+        GridReference() : Reference<GridRefManager<OBJECT>, OBJECT>(), _denseIndex(0) { }
         ~GridReference() { this->unlink(); }
         GridReference* next() { return (GridReference*)Reference<GridRefManager<OBJECT>, OBJECT>::next(); }
+        void SetPosition(float x, float y) { this->getTarget()->SetDensePosition(_denseIndex, x, y); }
+
+    private:
+        friend class GridRefManager<OBJECT>;
+
+        uint32 _denseIndex;                                 // slot of this reference in GridRefManager::_objects
 };
 #endif
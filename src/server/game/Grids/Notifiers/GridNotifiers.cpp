@@ -24,9 +24,18 @@
 #include "Transport.h"
 #include "ObjectAccessor.h"
 #include "CellImpl.h"
+#include "World.h"
 
 using namespace Trinity;
 
+bool VisibleNotifier::IsSkippedDistant(WorldObject const* target) const
+{
+    if (i_distantRangeSq <= 0.0f)
+        return false;
+
+    return i_player.m_seer->GetExactDist2dSq(target) > i_distantRangeSq && i_player.HaveAtClient(target);
+}
+
 void VisibleNotifier::SendToSelf()
 {
     // at this moment i_clientGUIDs have guids that not iterate at grid level checks
@@ -149,7 +158,8 @@ void PlayerRelocationNotifier::Visit(PlayerMapType &m)
 
         vis_guids.erase(player->GetGUID());
 
-        i_player.UpdateVisibilityOf(player, i_data, i_visibleNow);
+        if (!IsSkippedDistant(player))
+            i_player.UpdateVisibilityOf(player, i_data, i_visibleNow);
 
         if (player->m_seer->isNeedNotify(NOTIFY_VISIBILITY_CHANGED))
             continue;
@@ -168,7 +178,8 @@ void PlayerRelocationNotifier::Visit(CreatureMapType &m)
 
         vis_guids.erase(c->GetGUID());
 
-        i_player.UpdateVisibilityOf(c, i_data, i_visibleNow);
+        if (!IsSkippedDistant(c))
+            i_player.UpdateVisibilityOf(c, i_data, i_visibleNow);
 
         if (relocated_for_ai && !c->isNeedNotify(NOTIFY_VISIBILITY_CHANGED))
             CreatureUnitRelocationWorker(c, &i_player);
@@ -203,50 +214,55 @@ void CreatureRelocationNotifier::Visit(CreatureMapType &m)
     }
 }
 
-void DelayedUnitRelocation::Visit(CreatureMapType &m)
+void DelayedUnitRelocation::Notify(Creature* unit)
 {
-    for (CreatureMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
-    {
-        Creature* unit = iter->GetSource();
-        if (!unit->isNeedNotify(NOTIFY_VISIBILITY_CHANGED))
-            continue;
+    CellCoord pair(Trinity::ComputeCellCoord(unit->GetPositionX(), unit->GetPositionY()));
+    Cell cell(pair);
+    cell.SetNoCreate();
 
-        CreatureRelocationNotifier relocate(*unit);
+    CreatureRelocationNotifier relocate(*unit);
 
-        TypeContainerVisitor<CreatureRelocationNotifier, WorldTypeMapContainer > c2world_relocation(relocate);
-        TypeContainerVisitor<CreatureRelocationNotifier, GridTypeMapContainer >  c2grid_relocation(relocate);
+    TypeContainerVisitor<CreatureRelocationNotifier, WorldTypeMapContainer > c2world_relocation(relocate);
+    TypeContainerVisitor<CreatureRelocationNotifier, GridTypeMapContainer >  c2grid_relocation(relocate);
 
-        cell.Visit(p, c2world_relocation, i_map, *unit, i_radius);
-        cell.Visit(p, c2grid_relocation, i_map, *unit, i_radius);
-    }
+    cell.Visit(pair, c2world_relocation, i_map, *unit, i_radius);
+    cell.Visit(pair, c2grid_relocation, i_map, *unit, i_radius);
 }
 
-void DelayedUnitRelocation::Visit(PlayerMapType &m)
+void DelayedUnitRelocation::Notify(Player* player)
 {
-    for (PlayerMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
-    {
-        Player* player = iter->GetSource();
-        WorldObject const* viewPoint = player->m_seer;
+    WorldObject const* viewPoint = player->m_seer;
 
-        if (!viewPoint->isNeedNotify(NOTIFY_VISIBILITY_CHANGED))
-            continue;
+    if (!viewPoint->isNeedNotify(NOTIFY_VISIBILITY_CHANGED))
+        return;
 
-        if (player != viewPoint && !viewPoint->IsPositionValid())
-            continue;
+    if (player != viewPoint && !viewPoint->IsPositionValid())
+        return;
+
+    i_map.UpdatePlayerInterest(player);
 
-        CellCoord pair2(Trinity::ComputeCellCoord(viewPoint->GetPositionX(), viewPoint->GetPositionY()));
-        Cell cell2(pair2);
-        //cell.SetNoCreate(); need load cells around viewPoint or player, that's why its commented
+    // level of detail, objects far from the view point are checked only every few updates
+    float distantRange = 0.0f;
+    if (uint32 lodDistance = sWorld->getIntConfig(CONFIG_VISIBILITY_LOD_DISTANCE))
+    {
+        if (++player->m_distantVisibilitySkips < sWorld->getIntConfig(CONFIG_VISIBILITY_LOD_INTERVAL))
+            distantRange = player->GetSightRange() * lodDistance / 100.0f;
+        else
+            player->m_distantVisibilitySkips = 0;
+    }
 
-        PlayerRelocationNotifier relocate(*player);
-        TypeContainerVisitor<PlayerRelocationNotifier, WorldTypeMapContainer > c2world_relocation(relocate);
-        TypeContainerVisitor<PlayerRelocationNotifier, GridTypeMapContainer >  c2grid_relocation(relocate);
+    CellCoord pair(Trinity::ComputeCellCoord(viewPoint->GetPositionX(), viewPoint->GetPositionY()));
+    Cell cell(pair);
+    //cell.SetNoCreate(); need load cells around viewPoint or player, that's why its commented
 
-        cell2.Visit(pair2, c2world_relocation, i_map, *viewPoint, i_radius);
-        cell2.Visit(pair2, c2grid_relocation, i_map, *viewPoint, i_radius);
+    PlayerRelocationNotifier relocate(*player, distantRange);
+    TypeContainerVisitor<PlayerRelocationNotifier, WorldTypeMapContainer > c2world_relocation(relocate);
+    TypeContainerVisitor<PlayerRelocationNotifier, GridTypeMapContainer >  c2grid_relocation(relocate);
 
-        relocate.SendToSelf();
-    }
+    cell.Visit(pair, c2world_relocation, i_map, *viewPoint, i_radius);
+    cell.Visit(pair, c2grid_relocation, i_map, *viewPoint, i_radius);
+
+    relocate.SendToSelf();
 }
 
 void AIRelocationNotifier::Visit(CreatureMapType &m)
@@ -262,14 +278,10 @@ void AIRelocationNotifier::Visit(CreatureMapType &m)
 
 void MessageDistDeliverer::Visit(PlayerMapType &m)
 {
-    for (PlayerMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
+    m.VisitInRange2d(i_source->GetPositionX(), i_source->GetPositionY(), i_distSq, [this](Player* target)
     {
-        Player* target = iter->GetSource();
         if (!target->IsInPhase(i_source))
-            continue;
-
-        if (target->GetExactDist2dSq(i_source) > i_distSq)
-            continue;
+            return;
 
         // Send packet to all who are sharing the player's vision
         if (target->HasSharedVision())
@@ -282,19 +294,15 @@ void MessageDistDeliverer::Visit(PlayerMapType &m)
 
         if (target->m_seer == target || target->GetVehicle())
             SendPacket(target);
-    }
+    });
 }
 
 void MessageDistDeliverer::Visit(CreatureMapType &m)
 {
-    for (CreatureMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
+    m.VisitInRange2d(i_source->GetPositionX(), i_source->GetPositionY(), i_distSq, [this](Creature* target)
     {
-        Creature* target = iter->GetSource();
         if (!target->IsInPhase(i_source))
-            continue;
-
-        if (target->GetExactDist2dSq(i_source) > i_distSq)
-            continue;
+            return;
 
         // Send packet to all who are sharing the creature's vision
         if (target->HasSharedVision())
@@ -304,19 +312,15 @@ void MessageDistDeliverer::Visit(CreatureMapType &m)
                 if ((*i)->m_seer == target)
                     SendPacket(*i);
         }
-    }
+    });
 }
 
 void MessageDistDeliverer::Visit(DynamicObjectMapType &m)
 {
-    for (DynamicObjectMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
+    m.VisitInRange2d(i_source->GetPositionX(), i_source->GetPositionY(), i_distSq, [this](DynamicObject* target)
     {
-        DynamicObject* target = iter->GetSource();
         if (!target->IsInPhase(i_source))
-            continue;
-
-        if (target->GetExactDist2dSq(i_source) > i_distSq)
-            continue;
+            return;
 
         if (Unit* caster = target->GetCaster())
         {
@@ -325,7 +329,57 @@ void MessageDistDeliverer::Visit(DynamicObjectMapType &m)
             if (player && player->m_seer == target)
                 SendPacket(player);
         }
-    }
+    });
+}
+
+void BroadcastReceiverCollector::Visit(PlayerMapType &m)
+{
+    m.VisitInRange2d(i_source->GetPositionX(), i_source->GetPositionY(), i_distSq, [this](Player* target)
+    {
+        if (!target->IsInPhase(i_source))
+            return;
+
+        if (target->HasSharedVision())
+        {
+            SharedVisionList::const_iterator i = target->GetSharedVisionList().begin();
+            for (; i != target->GetSharedVisionList().end(); ++i)
+                if ((*i)->m_seer == target)
+                    AddReceiver(*i, target);
+        }
+
+        if (target->m_seer == target || target->GetVehicle())
+            AddReceiver(target, target);
+    });
+}
+
+void BroadcastReceiverCollector::Visit(CreatureMapType &m)
+{
+    m.VisitInRange2d(i_source->GetPositionX(), i_source->GetPositionY(), i_distSq, [this](Creature* target)
+    {
+        if (!target->IsInPhase(i_source) || !target->HasSharedVision())
+            return;
+
+        SharedVisionList::const_iterator i = target->GetSharedVisionList().begin();
+        for (; i != target->GetSharedVisionList().end(); ++i)
+            if ((*i)->m_seer == target)
+                AddReceiver(*i, target);
+    });
+}
+
+void BroadcastReceiverCollector::Visit(DynamicObjectMapType &m)
+{
+    m.VisitInRange2d(i_source->GetPositionX(), i_source->GetPositionY(), i_distSq, [this](DynamicObject* target)
+    {
+        if (!target->IsInPhase(i_source))
+            return;
+
+        if (Unit* caster = target->GetCaster())
+        {
+            Player* player = caster->ToPlayer();
+            if (player && player->m_seer == target)
+                AddReceiver(player, target);
+        }
+    });
 }
 
 /*
@@ -347,6 +401,39 @@ void ObjectUpdater::Visit(GridRefManager<T> &m)
             iter->GetSource()->Update(i_timeDiff);
 }
 
+// owned or charmed units, shared vision, formations, vehicles and zone scripts link a creature to objects anywhere on the map
+static bool NeedsSerialUpdate(Creature* creature)
+{
+    if (creature->GetZoneScript() || !creature->GetCharmerOrOwnerGUID().IsEmpty() || creature->HasSharedVision() || creature->GetFormation() || creature->GetVehicleKit())
+        return true;
+
+    // threat and hostile references have no range limit, two regions fighting the same unit would change its lists at once
+    ThreatManager& threatManager = creature->getThreatManager();
+    return creature->IsInCombat() || !threatManager.isThreatListEmpty() || !threatManager.getOfflineThreatList().empty() ||
+        !creature->getHostileRefManager().isEmpty();
+}
+
+void ObjectUpdater::Visit(CreatureMapType &m)
+{
+    for (CreatureMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
+    {
+        Creature* creature = iter->GetSource();
+        if (!creature->IsInWorld())
+            continue;
+
+        if (i_serialCreatures && NeedsSerialUpdate(creature))
+        {
+            i_serialCreatures->push_back(creature);
+            continue;
+        }
+
+        if (!i_observed && creature->CanHibernate())
+            creature->Hibernate(i_timeDiff);
+        else
+            creature->Update(i_timeDiff);
+    }
+}
+
 bool AnyDeadUnitObjectInRangeCheck::operator()(Player* u)
 {
     return !u->IsAlive() && !u->HasAuraType(SPELL_AURA_GHOST) && i_searchObj->IsWithinDistInMap(u, i_range);
@@ -377,7 +464,6 @@ bool AnyDeadUnitSpellTargetInRangeCheck::operator()(Creature* u)
     return AnyDeadUnitObjectInRangeCheck::operator()(u) && i_check(u);
 }
 
-template void ObjectUpdater::Visit<Creature>(CreatureMapType&);
 template void ObjectUpdater::Visit<GameObject>(GameObjectMapType&);
 template void ObjectUpdater::Visit<DynamicObject>(DynamicObjectMapType&);
 template void ObjectUpdater::Visit<AreaTrigger>(AreaTriggerMapType &);
@@ -46,9 +46,12 @@ namespace Trinity
         UpdateData i_data;
         std::set<Unit*> i_visibleNow;
         GuidUnorderedSet vis_guids;
+        float i_distantRangeSq;                             // objects at the client further away are not checked again
 
-        VisibleNotifier(Player &player) : i_player(player), i_data(player.GetMapId()), vis_guids(player.m_clientGUIDs) { }
+        VisibleNotifier(Player &player, float distantRange = 0.0f) : i_player(player), i_data(player.GetMapId()), vis_guids(player.m_clientGUIDs),
+            i_distantRangeSq(distantRange * distantRange) { }
         template<class T> void Visit(GridRefManager<T> &m);
+        bool IsSkippedDistant(WorldObject const* target) const;
         void SendToSelf(void);
     };
 
@@ -65,7 +68,7 @@ namespace Trinity
 
     struct PlayerRelocationNotifier : public VisibleNotifier
     {
-        PlayerRelocationNotifier(Player &player) : VisibleNotifier(player) { }
+        PlayerRelocationNotifier(Player &player, float distantRange = 0.0f) : VisibleNotifier(player, distantRange) { }
 
         template<class T> void Visit(GridRefManager<T> &m) { VisibleNotifier::Visit(m); }
         void Visit(CreatureMapType &);
@@ -84,14 +87,10 @@ namespace Trinity
     struct DelayedUnitRelocation
     {
         Map &i_map;
-        Cell &cell;
-        CellCoord &p;
         const float i_radius;
-        DelayedUnitRelocation(Cell &c, CellCoord &pair, Map &map, float radius) :
-            i_map(map), cell(c), p(pair), i_radius(radius) { }
-        template<class T> void Visit(GridRefManager<T> &) { }
-        void Visit(CreatureMapType &);
-        void Visit(PlayerMapType   &);
+        DelayedUnitRelocation(Map &map, float radius) : i_map(map), i_radius(radius) { }
+        void Notify(Creature* unit);
+        void Notify(Player* player);
     };
 
     struct AIRelocationNotifier
@@ -127,6 +126,7 @@ namespace Trinity
     {
         WorldObject* i_source;
         WorldPacket const* i_message;
+        SharedPacketPtr i_sharedMessage;                    // copied on the first receiver, referenced by the others
         float i_distSq;
         uint32 team;
         Player const* skipped_receiver;
@@ -155,15 +155,50 @@ namespace Trinity
                 return;
 
             if (WorldSession* session = player->GetSession())
-                session->SendPacket(i_message);
+            {
+                if (!i_sharedMessage)
+                    i_sharedMessage = std::make_shared<SharedPacket>(*i_message);
+
+                session->SendSharedPacket(i_sharedMessage);
+            }
+        }
+    };
+
+    // the receivers MessageDistDeliverer would pick, with the distance of what they see through, for Map::DeliverBroadcasts
+    struct BroadcastReceiverCollector
+    {
+        WorldObject const* i_source;
+        float i_distSq;
+        std::vector<std::pair<Player*, float /*distSq*/>>& i_receivers;
+        BroadcastReceiverCollector(WorldObject const* src, float distSq, std::vector<std::pair<Player*, float>>& receivers)
+            : i_source(src), i_distSq(distSq), i_receivers(receivers) { }
+
+        void Visit(PlayerMapType &m);
+        void Visit(CreatureMapType &m);
+        void Visit(DynamicObjectMapType &m);
+        template<class SKIP> void Visit(GridRefManager<SKIP> &) { }
+
+        void AddReceiver(Player* player, WorldObject const* target)
+        {
+            // never send packet to self
+            if (player == i_source)
+                return;
+
+            if (!player->HaveAtClient(i_source))
+                return;
+
+            i_receivers.emplace_back(player, target->GetExactDist2dSq(i_source));
         }
     };
 
     struct ObjectUpdater
     {
         uint32 i_timeDiff;
-        explicit ObjectUpdater(const uint32 diff) : i_timeDiff(diff) { }
+        bool i_observed;                                    // a player sees into the visited cell
+        std::vector<Creature*>* i_serialCreatures;          // set while updating a parallel region, collects creatures that may reach into other regions
+        explicit ObjectUpdater(const uint32 diff) : i_timeDiff(diff), i_observed(true), i_serialCreatures(nullptr) { }
         template<class T> void Visit(GridRefManager<T> &m);
+        void Visit(CreatureMapType &m);
         void Visit(PlayerMapType &) { }
         void Visit(CorpseMapType &) { }
     };
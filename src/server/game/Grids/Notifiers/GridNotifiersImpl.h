@@ -34,6 +34,9 @@ inline void Trinity::VisibleNotifier::Visit(GridRefManager<T> &m)
     for (typename GridRefManager<T>::iterator iter = m.begin(); iter != m.end(); ++iter)
     {
         vis_guids.erase(iter->GetSource()->GetGUID());
+        if (IsSkippedDistant(iter->GetSource()))
+            continue;
+
         i_player.UpdateVisibilityOf(iter->GetSource(), i_data, i_visibleNow);
     }
 }
@@ -52,14 +55,14 @@ void Trinity::WorldObjectSearcher<Check>::Visit(GameObjectMapType &m)
     if (i_object)
         return;
 
-    for (GameObjectMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (GameObject* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
+        if (i_check(obj))
         {
-            i_object = itr->GetSource();
+            i_object = obj;
             return;
         }
     }
@@ -75,14 +78,14 @@ void Trinity::WorldObjectSearcher<Check>::Visit(PlayerMapType &m)
     if (i_object)
         return;
 
-    for (PlayerMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (Player* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
+        if (i_check(obj))
         {
-            i_object = itr->GetSource();
+            i_object = obj;
             return;
         }
     }
@@ -98,14 +101,14 @@ void Trinity::WorldObjectSearcher<Check>::Visit(CreatureMapType &m)
     if (i_object)
         return;
 
-    for (CreatureMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (Creature* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
+        if (i_check(obj))
         {
-            i_object = itr->GetSource();
+            i_object = obj;
             return;
         }
     }
@@ -121,14 +124,14 @@ void Trinity::WorldObjectSearcher<Check>::Visit(CorpseMapType &m)
     if (i_object)
         return;
 
-    for (CorpseMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (Corpse* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
+        if (i_check(obj))
         {
-            i_object = itr->GetSource();
+            i_object = obj;
             return;
         }
     }
@@ -144,14 +147,14 @@ void Trinity::WorldObjectSearcher<Check>::Visit(DynamicObjectMapType &m)
     if (i_object)
         return;
 
-    for (DynamicObjectMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (DynamicObject* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
+        if (i_check(obj))
         {
-            i_object = itr->GetSource();
+            i_object = obj;
             return;
         }
     }
@@ -167,14 +170,14 @@ void Trinity::WorldObjectSearcher<Check>::Visit(AreaTriggerMapType &m)
     if (i_object)
         return;
 
-    for (AreaTriggerMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (AreaTrigger* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
+        if (i_check(obj))
         {
-            i_object = itr->GetSource();
+            i_object = obj;
             return;
         }
     }
@@ -186,13 +189,13 @@ void Trinity::WorldObjectLastSearcher<Check>::Visit(GameObjectMapType &m)
     if (!(i_mapTypeMask & GRID_MAP_TYPE_MASK_GAMEOBJECT))
         return;
 
-    for (GameObjectMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (GameObject* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
-            i_object = itr->GetSource();
+        if (i_check(obj))
+            i_object = obj;
     }
 }
 
@@ -202,13 +205,13 @@ void Trinity::WorldObjectLastSearcher<Check>::Visit(PlayerMapType &m)
     if (!(i_mapTypeMask & GRID_MAP_TYPE_MASK_PLAYER))
         return;
 
-    for (PlayerMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (Player* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
-            i_object = itr->GetSource();
+        if (i_check(obj))
+            i_object = obj;
     }
 }
 
@@ -218,13 +221,13 @@ void Trinity::WorldObjectLastSearcher<Check>::Visit(CreatureMapType &m)
     if (!(i_mapTypeMask & GRID_MAP_TYPE_MASK_CREATURE))
         return;
 
-    for (CreatureMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (Creature* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
-            i_object = itr->GetSource();
+        if (i_check(obj))
+            i_object = obj;
     }
 }
 
@@ -234,13 +237,13 @@ void Trinity::WorldObjectLastSearcher<Check>::Visit(CorpseMapType &m)
     if (!(i_mapTypeMask & GRID_MAP_TYPE_MASK_CORPSE))
         return;
 
-    for (CorpseMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (Corpse* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
-            i_object = itr->GetSource();
+        if (i_check(obj))
+            i_object = obj;
     }
 }
 
@@ -250,13 +253,13 @@ void Trinity::WorldObjectLastSearcher<Check>::Visit(DynamicObjectMapType &m)
     if (!(i_mapTypeMask & GRID_MAP_TYPE_MASK_DYNAMICOBJECT))
         return;
 
-    for (DynamicObjectMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (DynamicObject* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
-            i_object = itr->GetSource();
+        if (i_check(obj))
+            i_object = obj;
     }
 }
 
@@ -266,13 +269,13 @@ void Trinity::WorldObjectLastSearcher<Check>::Visit(AreaTriggerMapType &m)
     if (!(i_mapTypeMask & GRID_MAP_TYPE_MASK_AREATRIGGER))
         return;
 
-    for (AreaTriggerMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (AreaTrigger* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
-            i_object = itr->GetSource();
+        if (i_check(obj))
+            i_object = obj;
     }
 }
 
@@ -282,9 +285,9 @@ void Trinity::WorldObjectListSearcher<Check>::Visit(PlayerMapType &m)
     if (!(i_mapTypeMask & GRID_MAP_TYPE_MASK_PLAYER))
         return;
 
-    for (PlayerMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
-        if (i_check(itr->GetSource()))
-            i_objects.push_back(itr->GetSource());
+    for (Player* obj : m.GetObjects())
+        if (i_check(obj))
+            i_objects.push_back(obj);
 }
 
 template<class Check>
@@ -293,9 +296,9 @@ void Trinity::WorldObjectListSearcher<Check>::Visit(CreatureMapType &m)
     if (!(i_mapTypeMask & GRID_MAP_TYPE_MASK_CREATURE))
         return;
 
-    for (CreatureMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
-        if (i_check(itr->GetSource()))
-            i_objects.push_back(itr->GetSource());
+    for (Creature* obj : m.GetObjects())
+        if (i_check(obj))
+            i_objects.push_back(obj);
 }
 
 template<class Check>
@@ -304,9 +307,9 @@ void Trinity::WorldObjectListSearcher<Check>::Visit(CorpseMapType &m)
     if (!(i_mapTypeMask & GRID_MAP_TYPE_MASK_CORPSE))
         return;
 
-    for (CorpseMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
-        if (i_check(itr->GetSource()))
-            i_objects.push_back(itr->GetSource());
+    for (Corpse* obj : m.GetObjects())
+        if (i_check(obj))
+            i_objects.push_back(obj);
 }
 
 template<class Check>
@@ -315,9 +318,9 @@ void Trinity::WorldObjectListSearcher<Check>::Visit(GameObjectMapType &m)
     if (!(i_mapTypeMask & GRID_MAP_TYPE_MASK_GAMEOBJECT))
         return;
 
-    for (GameObjectMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
-        if (i_check(itr->GetSource()))
-            i_objects.push_back(itr->GetSource());
+    for (GameObject* obj : m.GetObjects())
+        if (i_check(obj))
+            i_objects.push_back(obj);
 }
 
 template<class Check>
@@ -326,9 +329,9 @@ void Trinity::WorldObjectListSearcher<Check>::Visit(DynamicObjectMapType &m)
     if (!(i_mapTypeMask & GRID_MAP_TYPE_MASK_DYNAMICOBJECT))
         return;
 
-    for (DynamicObjectMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
-        if (i_check(itr->GetSource()))
-            i_objects.push_back(itr->GetSource());
+    for (DynamicObject* obj : m.GetObjects())
+        if (i_check(obj))
+            i_objects.push_back(obj);
 }
 
 template<class Check>
@@ -337,9 +340,9 @@ void Trinity::WorldObjectListSearcher<Check>::Visit(AreaTriggerMapType &m)
     if (!(i_mapTypeMask & GRID_MAP_TYPE_MASK_AREATRIGGER))
         return;
 
-    for (AreaTriggerMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
-        if (i_check(itr->GetSource()))
-            i_objects.push_back(itr->GetSource());
+    for (AreaTrigger* obj : m.GetObjects())
+        if (i_check(obj))
+            i_objects.push_back(obj);
 }
 
 // Gameobject searchers
@@ -351,14 +354,14 @@ void Trinity::GameObjectSearcher<Check>::Visit(GameObjectMapType &m)
     if (i_object)
         return;
 
-    for (GameObjectMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (GameObject* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
+        if (i_check(obj))
         {
-            i_object = itr->GetSource();
+            i_object = obj;
             return;
         }
     }
@@ -367,23 +370,23 @@ void Trinity::GameObjectSearcher<Check>::Visit(GameObjectMapType &m)
 template<class Check>
 void Trinity::GameObjectLastSearcher<Check>::Visit(GameObjectMapType &m)
 {
-    for (GameObjectMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (GameObject* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
-            i_object = itr->GetSource();
+        if (i_check(obj))
+            i_object = obj;
     }
 }
 
 template<class Check>
 void Trinity::GameObjectListSearcher<Check>::Visit(GameObjectMapType &m)
 {
-    for (GameObjectMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
-        if (itr->GetSource()->IsInPhase(_searcher))
-            if (i_check(itr->GetSource()))
-                i_objects.push_back(itr->GetSource());
+    for (GameObject* obj : m.GetObjects())
+        if (obj->IsInPhase(_searcher))
+            if (i_check(obj))
+                i_objects.push_back(obj);
 }
 
 // Unit searchers
@@ -395,14 +398,14 @@ void Trinity::UnitSearcher<Check>::Visit(CreatureMapType &m)
     if (i_object)
         return;
 
-    for (CreatureMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (Creature* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
+        if (i_check(obj))
         {
-            i_object = itr->GetSource();
+            i_object = obj;
             return;
         }
     }
@@ -415,14 +418,14 @@ void Trinity::UnitSearcher<Check>::Visit(PlayerMapType &m)
     if (i_object)
         return;
 
-    for (PlayerMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (Player* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
+        if (i_check(obj))
         {
-            i_object = itr->GetSource();
+            i_object = obj;
             return;
         }
     }
@@ -431,45 +434,45 @@ void Trinity::UnitSearcher<Check>::Visit(PlayerMapType &m)
 template<class Check>
 void Trinity::UnitLastSearcher<Check>::Visit(CreatureMapType &m)
 {
-    for (CreatureMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (Creature* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
-            i_object = itr->GetSource();
+        if (i_check(obj))
+            i_object = obj;
     }
 }
 
 template<class Check>
 void Trinity::UnitLastSearcher<Check>::Visit(PlayerMapType &m)
 {
-    for (PlayerMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (Player* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
-            i_object = itr->GetSource();
+        if (i_check(obj))
+            i_object = obj;
     }
 }
 
 template<class Check>
 void Trinity::UnitListSearcher<Check>::Visit(PlayerMapType &m)
 {
-    for (PlayerMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
-        if (itr->GetSource()->IsInPhase(_searcher))
-            if (i_check(itr->GetSource()))
-                i_objects.push_back(itr->GetSource());
+    for (Player* obj : m.GetObjects())
+        if (obj->IsInPhase(_searcher))
+            if (i_check(obj))
+                i_objects.push_back(obj);
 }
 
 template<class Check>
 void Trinity::UnitListSearcher<Check>::Visit(CreatureMapType &m)
 {
-    for (CreatureMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
-        if (itr->GetSource()->IsInPhase(_searcher))
-            if (i_check(itr->GetSource()))
-                i_objects.push_back(itr->GetSource());
+    for (Creature* obj : m.GetObjects())
+        if (obj->IsInPhase(_searcher))
+            if (i_check(obj))
+                i_objects.push_back(obj);
 }
 
 // Creature searchers
@@ -481,14 +484,14 @@ void Trinity::CreatureSearcher<Check>::Visit(CreatureMapType &m)
     if (i_object)
         return;
 
-    for (CreatureMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (Creature* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
+        if (i_check(obj))
         {
-            i_object = itr->GetSource();
+            i_object = obj;
             return;
         }
     }
@@ -497,32 +500,32 @@ void Trinity::CreatureSearcher<Check>::Visit(CreatureMapType &m)
 template<class Check>
 void Trinity::CreatureLastSearcher<Check>::Visit(CreatureMapType &m)
 {
-    for (CreatureMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (Creature* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
-            i_object = itr->GetSource();
+        if (i_check(obj))
+            i_object = obj;
     }
 }
 
 template<class Check>
 void Trinity::CreatureListSearcher<Check>::Visit(CreatureMapType &m)
 {
-    for (CreatureMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
-        if (itr->GetSource()->IsInPhase(_searcher))
-            if (i_check(itr->GetSource()))
-                i_objects.push_back(itr->GetSource());
+    for (Creature* obj : m.GetObjects())
+        if (obj->IsInPhase(_searcher))
+            if (i_check(obj))
+                i_objects.push_back(obj);
 }
 
 template<class Check>
 void Trinity::PlayerListSearcher<Check>::Visit(PlayerMapType &m)
 {
-    for (PlayerMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
-        if (itr->GetSource()->IsInPhase(_searcher))
-            if (i_check(itr->GetSource()))
-                i_objects.push_back(itr->GetSource());
+    for (Player* obj : m.GetObjects())
+        if (obj->IsInPhase(_searcher))
+            if (i_check(obj))
+                i_objects.push_back(obj);
 }
 
 template<class Check>
@@ -532,14 +535,14 @@ void Trinity::PlayerSearcher<Check>::Visit(PlayerMapType &m)
     if (i_object)
         return;
 
-    for (PlayerMapType::iterator itr=m.begin(); itr != m.end(); ++itr)
+    for (Player* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
+        if (i_check(obj))
         {
-            i_object = itr->GetSource();
+            i_object = obj;
             return;
         }
     }
@@ -548,13 +551,13 @@ void Trinity::PlayerSearcher<Check>::Visit(PlayerMapType &m)
 template<class Check>
 void Trinity::PlayerLastSearcher<Check>::Visit(PlayerMapType& m)
 {
-    for (PlayerMapType::iterator itr = m.begin(); itr != m.end(); ++itr)
+    for (Player* obj : m.GetObjects())
     {
-        if (!itr->GetSource()->IsInPhase(_searcher))
+        if (!obj->IsInPhase(_searcher))
             continue;
 
-        if (i_check(itr->GetSource()))
-            i_object = itr->GetSource();
+        if (i_check(obj))
+            i_object = obj;
     }
 }
 
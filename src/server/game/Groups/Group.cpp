@@ -1663,6 +1663,7 @@ void Group::BroadcastAddonMessagePacket(WorldPacket const* packet, const std::st
 
 void Group::BroadcastPacket(WorldPacket const* packet, bool ignorePlayersInBGRaid, int group, ObjectGuid ignoredPlayer)
 {
+    SharedPacketPtr sharedPacket = std::make_shared<SharedPacket>(*packet);
     for (GroupReference* itr = GetFirstMember(); itr != NULL; itr = itr->next())
     {
         Player* player = itr->GetSource();
@@ -1670,7 +1671,7 @@ void Group::BroadcastPacket(WorldPacket const* packet, bool ignorePlayersInBGRai
             continue;
 
         if (player->GetSession() && (group == -1 || itr->getSubGroup() == group))
-            player->GetSession()->SendPacket(packet);
+            player->GetSession()->SendSharedPacket(sharedPacket);
     }
 }
 
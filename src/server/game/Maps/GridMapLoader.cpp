@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GridMapLoader.h"
+#include "Log.h"
+#include "Map.h"
+#include "StringFormat.h"
+#include "Timer.h"
+#include "World.h"
+
+// prefetched terrain nobody asked for is dropped after this time
+#define GRIDMAP_PREFETCH_EXPIRY         (60 * IN_MILLISECONDS)
+#define GRIDMAP_PREFETCH_MAX_ENTRIES    64
+
+void GridMapLoader::Initialize(uint32 threads)
+{
+    for (uint32 i = 0; i < threads; ++i)
+        _workerThreads.push_back(std::thread(&GridMapLoader::WorkerThread, this));
+}
+
+void GridMapLoader::Unload()
+{
+    _cancelationToken = true;
+
+    _queue.Cancel();
+
+    for (std::thread& thread : _workerThreads)
+        thread.join();
+
+    _workerThreads.clear();
+
+    std::lock_guard<std::mutex> lock(_lock);
+    for (std::pair<uint32 const, PrefetchEntry>& entry : _entries)
+        delete entry.second.Result;
+
+    _entries.clear();
+}
+
+void GridMapLoader::Prefetch(uint32 mapId, uint32 gx, uint32 gy)
+{
+    if (!IsEnabled())
+        return;
+
+    uint32 key = MakeKey(mapId, gx, gy);
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_entries.count(key))
+            return;
+
+        if (_entries.size() >= GRIDMAP_PREFETCH_MAX_ENTRIES)
+        {
+            RemoveExpiredEntries();
+            if (_entries.size() >= GRIDMAP_PREFETCH_MAX_ENTRIES)
+                return;
+        }
+
+        _entries[key];
+    }
+
+    _queue.Push(key);
+}
+
+GridMap* GridMapLoader::Take(uint32 mapId, uint32 gx, uint32 gy, bool& loaded)
+{
+    if (!IsEnabled())
+        return nullptr;
+
+    uint32 key = MakeKey(mapId, gx, gy);
+
+    std::unique_lock<std::mutex> lock(_lock);
+
+    auto itr = _entries.find(key);
+    while (itr != _entries.end() && itr->second.State == PREFETCH_STATE_LOADING)
+    {
+        _loadedCondition.wait(lock);
+        itr = _entries.find(key);
+    }
+
+    if (itr == _entries.end())
+        return nullptr;
+
+    // an entry that is still queued has no result, the caller reads the file itself and the worker skips the key
+    GridMap* gridMap = itr->second.Result;
+    loaded = itr->second.Loaded;
+    _entries.erase(itr);
+    return gridMap;
+}
+
+void GridMapLoader::Discard(uint32 mapId)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    for (auto itr = _entries.begin(); itr != _entries.end();)
+    {
+        if (GetMapIdFromKey(itr->first) == mapId && itr->second.State != PREFETCH_STATE_LOADING)
+        {
+            delete itr->second.Result;
+            itr = _entries.erase(itr);
+        }
+        else
+            ++itr;
+    }
+}
+
+void GridMapLoader::Update()
+{
+    if (!IsEnabled())
+        return;
+
+    std::lock_guard<std::mutex> lock(_lock);
+    RemoveExpiredEntries();
+}
+
+void GridMapLoader::RemoveExpiredEntries()
+{
+    uint32 now = getMSTime();
+    for (auto itr = _entries.begin(); itr != _entries.end();)
+    {
+        if (itr->second.State == PREFETCH_STATE_LOADED && getMSTimeDiff(itr->second.LoadTime, now) > GRIDMAP_PREFETCH_EXPIRY)
+        {
+            delete itr->second.Result;
+            itr = _entries.erase(itr);
+        }
+        else
+            ++itr;
+    }
+}
+
+void GridMapLoader::WorkerThread()
+{
+    while (true)
+    {
+        uint32 key = 0;
+
+        _queue.WaitAndPop(key);
+
+        if (_cancelationToken)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            auto itr = _entries.find(key);
+            if (itr == _entries.end() || itr->second.State != PREFETCH_STATE_QUEUED)
+                continue;
+
+            itr->second.State = PREFETCH_STATE_LOADING;
+        }
+
+        uint32 mapId = GetMapIdFromKey(key);
+        uint32 gx = (key >> 6) & 0x3F;
+        uint32 gy = key & 0x3F;
+
+        std::string fileName = Trinity::StringFormat("%smaps/%04u_%02u_%02u.map", sWorld->GetDataPath().c_str(), mapId, gx, gy);
+        TC_LOG_DEBUG("maps", "Prefetching map %s", fileName.c_str());
+
+        GridMap* gridMap = new GridMap();
+        bool loaded = gridMap->loadData(fileName.c_str());
+
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            PrefetchEntry& entry = _entries[key];
+            entry.State = PREFETCH_STATE_LOADED;
+            entry.Result = gridMap;
+            entry.Loaded = loaded;
+            entry.LoadTime = getMSTime();
+        }
+
+        _loadedCondition.notify_all();
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_GRIDMAPLOADER_H
+#define TRINITY_GRIDMAPLOADER_H
+
+#include "Define.h"
+#include "ProducerConsumerQueue.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class GridMap;
+
+/*
+ * Reads .map files of grids players are heading to on background threads.
+ * Map::LoadMap takes the prefetched GridMap instead of reading the file on
+ * the map thread, so crossing grid borders only costs creating the objects.
+ */
+class GridMapLoader
+{
+    public:
+        static GridMapLoader* instance()
+        {
+            static GridMapLoader instance;
+            return &instance;
+        }
+
+        void Initialize(uint32 threads);
+        void Unload();
+
+        bool IsEnabled() const { return !_workerThreads.empty(); }
+
+        // queues reading the terrain of grid gx, gy (map file coordinates), nothing happens if it is already queued or loaded
+        void Prefetch(uint32 mapId, uint32 gx, uint32 gy);
+
+        // returns the prefetched terrain, waiting for it if it is being read right now, nullptr if it was not prefetched
+        GridMap* Take(uint32 mapId, uint32 gx, uint32 gy, bool& loaded);
+
+        // drops all prefetched terrain of a map that is unloaded
+        void Discard(uint32 mapId);
+
+        // drops prefetched terrain of grids nobody entered in time, players may have turned away from them
+        void Update();
+
+    private:
+        GridMapLoader() : _cancelationToken(false) { }
+        ~GridMapLoader() { }
+
+        GridMapLoader(GridMapLoader const&);
+        GridMapLoader& operator=(GridMapLoader const&);
+
+        enum PrefetchState
+        {
+            PREFETCH_STATE_QUEUED,
+            PREFETCH_STATE_LOADING,
+            PREFETCH_STATE_LOADED
+        };
+
+        struct PrefetchEntry
+        {
+            PrefetchEntry() : State(PREFETCH_STATE_QUEUED), Result(nullptr), Loaded(false), LoadTime(0) { }
+
+            PrefetchState State;
+            GridMap* Result;
+            bool Loaded;
+            uint32 LoadTime;
+        };
+
+        static uint32 MakeKey(uint32 mapId, uint32 gx, uint32 gy) { return (mapId << 12) | (gx << 6) | gy; }
+        static uint32 GetMapIdFromKey(uint32 key) { return key >> 12; }
+
+        void RemoveExpiredEntries();
+        void WorkerThread();
+
+        std::mutex _lock;
+        std::condition_variable _loadedCondition;
+        std::unordered_map<uint32 /*key*/, PrefetchEntry> _entries;
+
+        ProducerConsumerQueue<uint32> _queue;
+        std::vector<std::thread> _workerThreads;
+        std::atomic<bool> _cancelationToken;
+};
+
+#define sGridMapLoader GridMapLoader::instance()
+
+#endif
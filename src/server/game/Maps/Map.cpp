@@ -22,6 +22,7 @@
 #include "CellImpl.h"
 #include "DisableMgr.h"
 #include "DynamicTree.h"
+#include "GridMapLoader.h"
 #include "GridNotifiers.h"
 #include "GridNotifiersImpl.h"
 #include "GridStates.h"
@@ -29,6 +30,7 @@
 #include "InstancePackets.h"
 #include "InstanceScript.h"
 #include "MapInstanced.h"
+#include "MapManager.h"
 #include "MiscPackets.h"
 #include "ObjectAccessor.h"
 #include "ObjectMgr.h"
@@ -39,6 +41,13 @@
 #include "VMapFactory.h"
 #include "Weather.h"
 
+#if PLATFORM != PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 u_map_magic MapMagic        = { {'M','A','P','S'} };
 u_map_magic MapVersionMagic = { {'v','1','.','5'} };
 u_map_magic MapAreaMagic    = { {'A','R','E','A'} };
@@ -49,6 +58,9 @@ u_map_magic MapLiquidMagic  = { {'M','L','I','Q'} };
 #define MAX_GRID_LOAD_TIME      50
 #define MAX_CREATURE_ATTACK_RADIUS  (45.0f * sWorld->getRate(RATE_CREATURE_AGGRO))
 
+// receivers whose SMSG_UPDATE_OBJECT are built by one MapUpdater task
+#define OBJECT_UPDATE_RECEIVERS_PER_TASK 64
+
 GridState* si_GridStates[MAX_GRID_STATE];
 
 
@@ -73,7 +85,12 @@ Map::~Map()
     if (!m_scriptSchedule.empty())
         sScriptMgr->DecreaseScheduledScriptCount(m_scriptSchedule.size());
 
+    SaveRespawnTransaction();
+
     MMAP::MMapFactory::createOrGetMMapManager()->unloadMapInstance(GetId(), i_InstanceId);
+
+    if (i_InstanceId == 0)
+        sGridMapLoader->Discard(GetId());
 }
 
 bool Map::ExistMap(uint32 mapid, int gx, int gy)
@@ -188,10 +205,20 @@ void Map::LoadMap(int gx, int gy, bool reload)
 
     // map file name
     std::string fileName = Trinity::StringFormat("%smaps/%04u_%02u_%02u.map", sWorld->GetDataPath().c_str(), GetId(), gx, gy);
-    TC_LOG_DEBUG("maps", "Loading map %s", fileName.c_str());
-    // loading data
-    GridMaps[gx][gy] = new GridMap();
-    if (!GridMaps[gx][gy]->loadData(fileName.c_str()))
+    // terrain of grids players are heading to may already be read by the prefetch threads
+    bool loaded = false;
+    if (!reload)
+        GridMaps[gx][gy] = sGridMapLoader->Take(GetId(), gx, gy, loaded);
+
+    if (!GridMaps[gx][gy])
+    {
+        TC_LOG_DEBUG("maps", "Loading map %s", fileName.c_str());
+        // loading data
+        GridMaps[gx][gy] = new GridMap();
+        loaded = GridMaps[gx][gy]->loadData(fileName.c_str());
+    }
+
+    if (!loaded)
         TC_LOG_ERROR("maps", "Error loading map file: %s", fileName.c_str());
 
     sScriptMgr->OnLoadGridMap(this, GridMaps[gx][gy], gx, gy);
@@ -225,13 +252,15 @@ void Map::DeleteStateMachine()
 }
 
 Map::Map(uint32 id, time_t expiry, uint32 InstanceId, uint8 SpawnMode, Map* _parent):
-_creatureToMoveLock(false), _gameObjectsToMoveLock(false), _dynamicObjectsToMoveLock(false),
+_creatureToMoveLock(false), _gameObjectsToMoveLock(false), _dynamicObjectsToMoveLock(false), _updatingRegions(false),
 i_mapEntry(sMapStore.LookupEntry(id)), i_spawnMode(SpawnMode), i_InstanceId(InstanceId),
 m_unloadTimer(0), m_VisibleDistance(DEFAULT_VISIBILITY_DISTANCE),
 m_VisibilityNotifyPeriod(DEFAULT_VISIBILITY_NOTIFY_PERIOD),
 m_activeNonPlayersIter(m_activeNonPlayers.end()), _transportsUpdateIter(_transports.end()),
 i_gridExpiry(expiry),
-i_scriptLock(false), _defaultLight(GetDefaultMapLight(id))
+i_scriptLock(false), _defaultLight(GetDefaultMapLight(id)), _updateCost(0),
+_updateInterval(0), _pendingUpdateDiff(0),
+_relocationNotifyTimer(0, irand(0, DEFAULT_VISIBILITY_NOTIFY_PERIOD)), _batchBroadcasts(false)
 {
     m_parentMap = (_parent ? _parent : this);
     for (unsigned int idx=0; idx < MAX_NUMBER_OF_GRIDS; ++idx)
@@ -523,10 +552,14 @@ bool Map::AddPlayerToMap(Player* player, bool initPlayer /*= true*/)
     EnsureGridLoadedForActiveObject(cell, player);
     AddToGrid(player, cell);
 
+    // back to full update rate until the next update decides otherwise
+    ResetUpdateInterval();
+
     // Check if we are adding to correct map
     ASSERT (player->GetMap() == this);
     player->SetMap(this);
     player->AddToWorld();
+    UpdatePlayerInterest(player);
 
     if (initPlayer)
         SendInitSelf(player);
@@ -565,6 +598,8 @@ void Map::InitializeObject(GameObject* obj)
 template<class T>
 bool Map::AddToMap(T* obj)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
+
     /// @todo Needs clean up. An object should not be added to map twice.
     if (obj->IsInWorld())
     {
@@ -650,7 +685,7 @@ bool Map::IsGridLoaded(const GridCoord &p) const
     return (getNGrid(p.x_coord, p.y_coord) && isGridObjectDataLoaded(p.x_coord, p.y_coord));
 }
 
-void Map::VisitNearbyCellsOf(WorldObject* obj, TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer> &gridVisitor, TypeContainerVisitor<Trinity::ObjectUpdater, WorldTypeMapContainer> &worldVisitor)
+void Map::AddActiveCellsAround(WorldObject const* obj)
 {
     // Check for valid position
     if (!obj->IsPositionValid())
@@ -663,25 +698,74 @@ void Map::VisitNearbyCellsOf(WorldObject* obj, TypeContainerVisitor<Trinity::Obj
     {
         for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
         {
-            // marked cells are those that have been visited
-            // don't visit the same cell twice
+            // marked cells are already in the set
             uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
             if (isCellMarked(cell_id))
                 continue;
 
             markCell(cell_id);
-            CellCoord pair(x, y);
-            Cell cell(pair);
-            cell.SetNoCreate();
-            Visit(cell, gridVisitor);
-            Visit(cell, worldVisitor);
+            _activeCells.push_back(CellCoord(x, y));
+        }
+    }
+}
+
+void Map::CollectActiveCells()
+{
+    _activeCells.clear();
+
+    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+    {
+        Player* player = m_mapRefIter->GetSource();
+        if (!player || !player->IsInWorld())
+            continue;
+
+        AddActiveCellsAround(player);
+
+        // Handle updates for creatures in combat with player and are more than 60 yards away
+        if (player->IsInCombat())
+        {
+            HostileReference* ref = player->getHostileRefManager().getFirst();
+            while (ref)
+            {
+                if (Unit* unit = ref->GetSource()->GetOwner())
+                    if (unit->ToCreature() && unit->GetMapId() == player->GetMapId() && !unit->IsWithinDistInMap(player, GetVisibilityRange(), false))
+                        AddActiveCellsAround(unit);
+
+                ref = ref->next();
+            }
         }
     }
+
+    for (WorldObject* obj : m_activeNonPlayers)
+        if (obj && obj->IsInWorld())
+            AddActiveCellsAround(obj);
+
+    // grid by grid, row by row inside a grid, so the pass walks each grid's cells together
+    std::sort(_activeCells.begin(), _activeCells.end(), [](ActiveCell const& leftCell, ActiveCell const& rightCell)
+    {
+        CellCoord const& left = leftCell.Coord;
+        CellCoord const& right = rightCell.Coord;
+        uint32 leftGrid = (left.y_coord / MAX_NUMBER_OF_CELLS) * MAX_NUMBER_OF_GRIDS + left.x_coord / MAX_NUMBER_OF_CELLS;
+        uint32 rightGrid = (right.y_coord / MAX_NUMBER_OF_CELLS) * MAX_NUMBER_OF_GRIDS + right.x_coord / MAX_NUMBER_OF_CELLS;
+        if (leftGrid != rightGrid)
+            return leftGrid < rightGrid;
+
+        return left.GetId() < right.GetId();
+    });
+
+    // cells kept active only by active objects or far fighting creatures are seen by no player
+    if (!sWorld->getBoolConfig(CONFIG_CREATURE_HIBERNATION))
+        return;
+
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
+    for (ActiveCell& cell : _activeCells)
+        cell.Observed = _cellObservers.find(cell.Coord.GetId()) != _cellObservers.end();
 }
 
 void Map::Update(const uint32 t_diff)
 {
-    _dynamicTree.update(t_diff);
+    _batchBroadcasts = true;
+
     /// update worldsessions for existing players
     for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
     {
@@ -694,9 +778,99 @@ void Map::Update(const uint32 t_diff)
             session->Update(t_diff, updater);
         }
     }
+
+    // sessions are answered every tick, objects and grids of a throttled map wait with the accumulated time until it is due
+    uint32 diff = 0;
+    if (!IsUpdateDue(t_diff, diff))
+    {
+        DeliverBroadcasts();
+        SendObjectUpdates();
+        _batchBroadcasts = false;
+        return;
+    }
+
+    _dynamicTree.update(diff);
+
     /// update active cells around players and active objects
     resetMarkedCells();
 
+    if (CanUpdateInRegions())
+        UpdateInRegions(diff);
+    else
+        UpdateActiveObjects(diff);
+
+    for (_transportsUpdateIter = _transports.begin(); _transportsUpdateIter != _transports.end();)
+    {
+        WorldObject* obj = *_transportsUpdateIter;
+        ++_transportsUpdateIter;
+
+        if (!obj->IsInWorld())
+            continue;
+
+        obj->Update(diff);
+    }
+
+    ProcessRespawns();
+
+    // broadcasts of this update reach the clients before the value changes they may refer to
+    DeliverBroadcasts();
+    SendObjectUpdates();
+
+    ///- Process necessary scripts
+    if (!m_scriptSchedule.empty())
+    {
+        i_scriptLock = true;
+        ScriptsProcess();
+        i_scriptLock = false;
+    }
+
+    MoveAllCreaturesInMoveList();
+    MoveAllGameObjectsInMoveList();
+
+    if (!m_mapRefManager.isEmpty() || !m_activeNonPlayers.empty())
+        ProcessRelocationNotifies(diff);
+
+    sScriptMgr->OnMapUpdate(this, diff);
+
+    DeliverBroadcasts();
+    _batchBroadcasts = false;
+
+    _updateInterval = CalculateUpdateInterval();
+}
+
+bool Map::IsUpdateDue(uint32 diff, uint32& updateDiff)
+{
+    _pendingUpdateDiff += diff;
+    if (_pendingUpdateDiff < _updateInterval)
+        return false;
+
+    updateDiff = _pendingUpdateDiff;
+    _pendingUpdateDiff = 0;
+    return true;
+}
+
+uint32 Map::CalculateUpdateInterval() const
+{
+    // nothing keeps any cell active, only sessions and transports would be updated
+    if (m_mapRefManager.isEmpty())
+        return m_activeNonPlayers.empty() ? sWorld->getIntConfig(CONFIG_MAP_UPDATE_INTERVAL_IDLE) : 0;
+
+    bool allAfk = true;
+    for (MapRefManager::const_iterator itr = m_mapRefManager.begin(); itr != m_mapRefManager.end(); ++itr)
+    {
+        Player const* player = itr->GetSource();
+        if (player->IsInCombat())
+            return 0;
+
+        if (!player->isAFK())
+            allAfk = false;
+    }
+
+    return allAfk ? sWorld->getIntConfig(CONFIG_MAP_UPDATE_INTERVAL_AFK) : 0;
+}
+
+void Map::UpdateActiveObjects(const uint32 t_diff)
+{
     Trinity::ObjectUpdater updater(t_diff);
     // for creature
     TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer  > grid_object_update(updater);
@@ -714,165 +888,428 @@ void Map::Update(const uint32 t_diff)
 
         // update players at tick
         player->Update(t_diff);
+    }
 
-        VisitNearbyCellsOf(player, grid_object_update, world_object_update);
+    // all cells around players and active objects are visited in a single pass
+    CollectActiveCells();
 
-        // Handle updates for creatures in combat with player and are more than 60 yards away
-        if (player->IsInCombat())
+    for (ActiveCell const& activeCell : _activeCells)
+    {
+        Cell cell(activeCell.Coord);
+        cell.SetNoCreate();
+        updater.i_observed = activeCell.Observed;
+        Visit(cell, grid_object_update);
+        Visit(cell, world_object_update);
+    }
+}
+
+bool Map::CanUpdateInRegions() const
+{
+    uint32 minPlayers = sWorld->getIntConfig(CONFIG_MAP_UPDATE_REGIONS_MIN_PLAYERS);
+    if (!minPlayers || Instanceable())
+        return false;
+
+    return m_mapRefManager.getSize() >= minPlayers && sMapMgr->GetMapUpdater()->activated();
+}
+
+void Map::UpdateInRegions(const uint32 t_diff)
+{
+    // players reach everything on the map (groups, pets, charms, shared vision, zone scripts, their own
+    // relocation), they are updated serially before the regions
+    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+    {
+        Player* player = m_mapRefIter->GetSource();
+        if (!player || !player->IsInWorld())
+            continue;
+
+        player->Update(t_diff);
+    }
+
+    // every grid is a region; cells are assigned to the grid they belong to, whoever activated them,
+    // so each cell is still updated only once per tick
+    std::map<uint32 /*gridId*/, MapRegion> regions;
+
+    CollectActiveCells();
+
+    // the active cells are sorted by grid, consecutive cells mostly share their region
+    MapRegion* region = nullptr;
+    uint32 regionGridId = 0;
+    for (ActiveCell const& activeCell : _activeCells)
+    {
+        Cell cell(activeCell.Coord);
+        uint32 gridId = cell.GridY() * MAX_NUMBER_OF_GRIDS + cell.GridX();
+        if (!region || gridId != regionGridId)
         {
-            std::vector<Creature*> updateList;
-            HostileReference* ref = player->getHostileRefManager().getFirst();
+            region = &regions[gridId];
+            regionGridId = gridId;
+        }
 
-            while (ref)
-            {
-                if (Unit* unit = ref->GetSource()->GetOwner())
-                    if (unit->ToCreature() && unit->GetMapId() == player->GetMapId() && !unit->IsWithinDistInMap(player, GetVisibilityRange(), false))
-                        updateList.push_back(unit->ToCreature());
+        region->Cells.push_back(activeCell);
+    }
 
-                ref = ref->next();
-            }
+    // regions are updated in four passes, a pass never contains two neighbouring grids so objects
+    // interacting within one grid distance are never touched by two threads at once
+    MapUpdater* updater = sMapMgr->GetMapUpdater();
+    _updatingRegions = true;
+    for (uint32 pass = 0; pass < 4; ++pass)
+    {
+        std::vector<std::function<void()>> tasks;
+        for (std::pair<uint32 const, MapRegion>& region : regions)
+        {
+            uint32 gridX = region.first % MAX_NUMBER_OF_GRIDS;
+            uint32 gridY = region.first / MAX_NUMBER_OF_GRIDS;
+            if ((gridX & 1) + 2 * (gridY & 1) != pass)
+                continue;
 
-            // Process deferred update list for player
-            for (Creature* c : updateList)
-                VisitNearbyCellsOf(c, grid_object_update, world_object_update);
+            MapRegion* updateRegion = &region.second;
+            tasks.push_back([this, updateRegion, t_diff]() { UpdateRegion(*updateRegion, t_diff); });
         }
+
+        updater->run_parallel(tasks);
     }
+    _updatingRegions = false;
+
+    // merge phase: objects whose side effects can cross regions. The world containers hold pets, corpses
+    // and the dynamic objects of players, creatures were set aside by the parallel passes
+    Trinity::ObjectUpdater serialUpdater(t_diff);
+    TypeContainerVisitor<Trinity::ObjectUpdater, WorldTypeMapContainer > world_object_update(serialUpdater);
 
-    // non-player active objects, increasing iterator in the loop in case of object removal
-    for (m_activeNonPlayersIter = m_activeNonPlayers.begin(); m_activeNonPlayersIter != m_activeNonPlayers.end();)
+    for (std::pair<uint32 const, MapRegion>& region : regions)
     {
-        WorldObject* obj = *m_activeNonPlayersIter;
-        ++m_activeNonPlayersIter;
+        for (ActiveCell const& activeCell : region.second.Cells)
+        {
+            Cell cell(activeCell.Coord);
+            cell.SetNoCreate();
+            Visit(cell, world_object_update);
+        }
 
-        if (!obj || !obj->IsInWorld())
-            continue;
+        // removed creatures are only deleted by DelayedUpdate, the pointers are still valid
+        for (Creature* creature : region.second.SerialCreatures)
+            if (creature->IsInWorld())
+                creature->Update(t_diff);
+    }
+}
+
+void Map::UpdateRegion(MapRegion& region, const uint32 t_diff)
+{
+    Trinity::ObjectUpdater updater(t_diff);
+    TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer  > grid_object_update(updater);
+    updater.i_serialCreatures = &region.SerialCreatures;
 
-        VisitNearbyCellsOf(obj, grid_object_update, world_object_update);
+    for (ActiveCell const& activeCell : region.Cells)
+    {
+        Cell cell(activeCell.Coord);
+        cell.SetNoCreate();
+        updater.i_observed = activeCell.Observed;
+        Visit(cell, grid_object_update);
     }
+}
 
-    for (_transportsUpdateIter = _transports.begin(); _transportsUpdateIter != _transports.end();)
+void Map::ProcessRelocationNotifies(const uint32 diff)
+{
+    _relocationNotifyTimer.TUpdate(diff);
+    if (!_relocationNotifyTimer.TPassed())
+        return;
+
+    _relocationNotifyTimer.TReset(diff, m_VisibilityNotifyPeriod);
+
+    // units flagged while the pass runs are queued for the next one
+    _unitsInNotify.swap(_unitsToNotify);
+
+    Trinity::DelayedUnitRelocation relocation(*this, MAX_VISIBILITY_DISTANCE);
+    for (size_t i = 0; i < _unitsInNotify.size(); ++i)
     {
-        WorldObject* obj = *_transportsUpdateIter;
-        ++_transportsUpdateIter;
+        // removed from the world by a notifier
+        Unit* unit = _unitsInNotify[i];
+        if (!unit)
+            continue;
 
-        if (!obj->IsInWorld())
+        // only cells updated this tick notify, units elsewhere stay queued with their flags
+        if (!isCellMarked(Trinity::ComputeCellCoord(unit->GetPositionX(), unit->GetPositionY()).GetId()))
+        {
+            _unitsToNotify.push_back(unit);
+            _unitsInNotify[i] = nullptr;
             continue;
+        }
 
-        obj->Update(t_diff);
+        if (Player* player = unit->ToPlayer())
+        {
+            if (player->m_seer == player)
+                relocation.Notify(player);
+        }
+        else if (Creature* creature = unit->ToCreature())
+            relocation.Notify(creature);
     }
 
-    SendObjectUpdates();
-
-    ///- Process necessary scripts
-    if (!m_scriptSchedule.empty())
+    // players looking through another unit are notified when their view point moved
+    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
     {
-        i_scriptLock = true;
-        ScriptsProcess();
-        i_scriptLock = false;
+        Player* player = m_mapRefIter->GetSource();
+        if (!player || !player->IsInWorld() || player->m_seer == player || !player->m_seer->isNeedNotify(NOTIFY_VISIBILITY_CHANGED))
+            continue;
+
+        if (!isCellMarked(Trinity::ComputeCellCoord(player->GetPositionX(), player->GetPositionY()).GetId()))
+            continue;
+
+        relocation.Notify(player);
     }
 
-    MoveAllCreaturesInMoveList();
-    MoveAllGameObjectsInMoveList();
+    for (Unit* unit : _unitsInNotify)
+        if (unit)
+            unit->ResetAllNotifies();
 
-    if (!m_mapRefManager.isEmpty() || !m_activeNonPlayers.empty())
-        ProcessRelocationNotifies(t_diff);
+    _unitsInNotify.clear();
+}
+
+void Map::AddUnitToNotify(Unit* unit)
+{
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
+
+    // the flag tells the unit is already queued
+    if (unit->isNeedNotify(NOTIFY_VISIBILITY_CHANGED))
+        return;
 
-    sScriptMgr->OnMapUpdate(this, t_diff);
+    unit->AddToNotify(NOTIFY_VISIBILITY_CHANGED);
+    _unitsToNotify.push_back(unit);
 }
 
-struct ResetNotifier
+void Map::RemoveUnitFromNotify(Unit* unit)
 {
-    template<class T>inline void resetNotify(GridRefManager<T> &m)
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
+
+    if (!unit->isNeedNotify(NOTIFY_VISIBILITY_CHANGED))
+        return;
+
+    unit->ResetAllNotifies();
+
+    std::vector<Unit*>::iterator itr = std::find(_unitsToNotify.begin(), _unitsToNotify.end(), unit);
+    if (itr != _unitsToNotify.end())
     {
-        for (typename GridRefManager<T>::iterator iter=m.begin(); iter != m.end(); ++iter)
-            iter->GetSource()->ResetAllNotifies();
+        *itr = _unitsToNotify.back();
+        _unitsToNotify.pop_back();
     }
-    template<class T> void Visit(GridRefManager<T> &) { }
-    void Visit(CreatureMapType &m) { resetNotify<Creature>(m);}
-    void Visit(PlayerMapType &m) { resetNotify<Player>(m);}
-};
 
-void Map::ProcessRelocationNotifies(const uint32 diff)
+    // the running pass iterates by index, the slot is only cleared
+    std::replace(_unitsInNotify.begin(), _unitsInNotify.end(), unit, static_cast<Unit*>(nullptr));
+}
+
+void Map::UpdatePlayerInterest(Player* player)
 {
-    for (GridRefManager<NGridType>::iterator i = GridRefManager<NGridType>::begin(); i != GridRefManager<NGridType>::end(); ++i)
-    {
-        NGridType *grid = i->GetSource();
+    WorldObject const* viewPoint = player->m_seer;
+    if (player != viewPoint && !viewPoint->IsPositionValid())
+        viewPoint = player;
 
-        if (grid->GetGridState() != GRID_STATE_ACTIVE)
-            continue;
+    CellArea area = Cell::CalculateCellArea(viewPoint->GetPositionX(), viewPoint->GetPositionY(), player->GetSightRange());
 
-        grid->getGridInfoRef()->getRelocationTimer().TUpdate(diff);
-        if (!grid->getGridInfoRef()->getRelocationTimer().TPassed())
-            continue;
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
 
-        uint32 gx = grid->getX(), gy = grid->getY();
+    CellArea oldArea;
+    std::unordered_map<Player*, CellArea>::iterator itr = _observedAreas.find(player);
+    bool subscribed = itr != _observedAreas.end();
+    if (subscribed)
+    {
+        oldArea = itr->second;
+        if (oldArea.low_bound == area.low_bound && oldArea.high_bound == area.high_bound)
+            return;
 
-        CellCoord cell_min(gx*MAX_NUMBER_OF_CELLS, gy*MAX_NUMBER_OF_CELLS);
-        CellCoord cell_max(cell_min.x_coord + MAX_NUMBER_OF_CELLS, cell_min.y_coord+MAX_NUMBER_OF_CELLS);
+        itr->second = area;
+    }
+    else
+        _observedAreas[player] = area;
 
-        for (uint32 x = cell_min.x_coord; x < cell_max.x_coord; ++x)
+    // only the cells entering or leaving the area change their observers
+    if (subscribed)
+    {
+        for (uint32 x = oldArea.low_bound.x_coord; x <= oldArea.high_bound.x_coord; ++x)
         {
-            for (uint32 y = cell_min.y_coord; y < cell_max.y_coord; ++y)
+            for (uint32 y = oldArea.low_bound.y_coord; y <= oldArea.high_bound.y_coord; ++y)
             {
-                uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
-                if (!isCellMarked(cell_id))
+                CellCoord cellCoord(x, y);
+                if (area.Contains(cellCoord))
                     continue;
 
-                CellCoord pair(x, y);
-                Cell cell(pair);
-                cell.SetNoCreate();
-
-                Trinity::DelayedUnitRelocation cell_relocation(cell, pair, *this, MAX_VISIBILITY_DISTANCE);
-                TypeContainerVisitor<Trinity::DelayedUnitRelocation, GridTypeMapContainer  > grid_object_relocation(cell_relocation);
-                TypeContainerVisitor<Trinity::DelayedUnitRelocation, WorldTypeMapContainer > world_object_relocation(cell_relocation);
-                Visit(cell, grid_object_relocation);
-                Visit(cell, world_object_relocation);
+                std::vector<Player*>& observers = _cellObservers[cellCoord.GetId()];
+                observers.erase(std::remove(observers.begin(), observers.end(), player), observers.end());
+                if (observers.empty())
+                    _cellObservers.erase(cellCoord.GetId());
             }
         }
     }
 
-    ResetNotifier reset;
-    TypeContainerVisitor<ResetNotifier, GridTypeMapContainer >  grid_notifier(reset);
-    TypeContainerVisitor<ResetNotifier, WorldTypeMapContainer > world_notifier(reset);
-    for (GridRefManager<NGridType>::iterator i = GridRefManager<NGridType>::begin(); i != GridRefManager<NGridType>::end(); ++i)
+    for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
     {
-        NGridType *grid = i->GetSource();
+        for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+        {
+            CellCoord cellCoord(x, y);
+            if (subscribed && oldArea.Contains(cellCoord))
+                continue;
 
-        if (grid->GetGridState() != GRID_STATE_ACTIVE)
-            continue;
+            _cellObservers[cellCoord.GetId()].push_back(player);
+        }
+    }
+}
 
-        if (!grid->getGridInfoRef()->getRelocationTimer().TPassed())
-            continue;
+void Map::RemovePlayerInterest(Player* player)
+{
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
+
+    std::unordered_map<Player*, CellArea>::iterator itr = _observedAreas.find(player);
+    if (itr == _observedAreas.end())
+        return;
+
+    CellArea const& area = itr->second;
+    for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
+    {
+        for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+        {
+            uint32 cellId = CellCoord(x, y).GetId();
+            std::vector<Player*>& observers = _cellObservers[cellId];
+            observers.erase(std::remove(observers.begin(), observers.end(), player), observers.end());
+            if (observers.empty())
+                _cellObservers.erase(cellId);
+        }
+    }
+
+    _observedAreas.erase(itr);
+}
+
+void Map::UpdateVisibilityForObservers(WorldObject* obj)
+{
+    CellCoord cellCoord = Trinity::ComputeCellCoord(obj->GetPositionX(), obj->GetPositionY());
+
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
+
+    std::unordered_map<uint32, std::vector<Player*>>::const_iterator itr = _cellObservers.find(cellCoord.GetId());
+    if (itr == _cellObservers.end())
+        return;
+
+    // copied, the observers of the cell may change while visibility is updated
+    std::vector<Player*> observers = itr->second;
+    for (Player* player : observers)
+        if (player != obj)
+            player->UpdateVisibilityOf(obj);
+}
+
+void Map::UpdateVisibilityForLeftObservers(WorldObject* obj, CellCoord const& oldCell)
+{
+    CellCoord cellCoord = Trinity::ComputeCellCoord(obj->GetPositionX(), obj->GetPositionY());
+    if (cellCoord == oldCell)
+        return;
+
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
+
+    std::unordered_map<uint32, std::vector<Player*>>::const_iterator itr = _cellObservers.find(oldCell.GetId());
+    if (itr == _cellObservers.end())
+        return;
+
+    // observers of the new cell got the object through UpdateVisibilityForObservers
+    std::vector<Player*> leftObservers;
+    for (Player* player : itr->second)
+        if (player != obj && !_observedAreas.find(player)->second.Contains(cellCoord))
+            leftObservers.push_back(player);
+
+    for (Player* player : leftObservers)
+        player->UpdateVisibilityOf(obj);
+}
+
+void Map::QueueBroadcast(WorldObject* source, WorldPacket const* data, float dist, bool ownTeamOnly, Player const* skipped)
+{
+    uint32 team = 0;
+    if (ownTeamOnly)
+        if (Player const* player = source->ToPlayer())
+            team = player->GetTeam();
+
+    // the one copy of the payload all receivers share, made before other regions wait on the lock
+    SharedPacketPtr packet = std::make_shared<SharedPacket>(*data);
+
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
+
+    _broadcasts.emplace_back(source, std::move(packet), dist * dist, team, skipped);
+    ++_broadcastCounts[source];
+}
 
-        grid->getGridInfoRef()->getRelocationTimer().TReset(diff, m_VisibilityNotifyPeriod);
+void Map::DeliverBroadcasts(WorldObject const* source /*= nullptr*/)
+{
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
+
+    std::vector<QueuedBroadcast> broadcasts;
+    if (source)
+    {
+        // only the broadcasts of an object leaving the map
+        if (!_broadcastCounts.erase(source))
+            return;
+
+        std::vector<QueuedBroadcast>::iterator itr = std::stable_partition(_broadcasts.begin(), _broadcasts.end(), [source](QueuedBroadcast const& broadcast)
+        {
+            return broadcast.Source != source;
+        });
+
+        std::move(itr, _broadcasts.end(), std::back_inserter(broadcasts));
+        _broadcasts.erase(itr, _broadcasts.end());
+    }
+    else
+    {
+        if (_broadcasts.empty())
+            return;
+
+        broadcasts.swap(_broadcasts);
+        _broadcastCounts.clear();
+    }
+
+    // one range search per source, as far as its furthest reaching broadcast
+    std::unordered_map<WorldObject const*, float /*distSq*/> rangeBySource;
+    for (QueuedBroadcast const& broadcast : broadcasts)
+    {
+        float& distSq = rangeBySource[broadcast.Source];
+        distSq = std::max(distSq, broadcast.DistSq);
+    }
 
-        uint32 gx = grid->getX(), gy = grid->getY();
+    std::unordered_map<WorldObject const*, std::vector<std::pair<Player*, float /*distSq*/>>> receiversBySource;
+    std::vector<std::pair<Player*, std::vector<SharedPacketPtr>>> packetsByReceiver;
+    std::unordered_map<Player*, size_t> receiverIndex;
 
-        CellCoord cell_min(gx*MAX_NUMBER_OF_CELLS, gy*MAX_NUMBER_OF_CELLS);
-        CellCoord cell_max(cell_min.x_coord + MAX_NUMBER_OF_CELLS, cell_min.y_coord+MAX_NUMBER_OF_CELLS);
+    for (QueuedBroadcast const& broadcast : broadcasts)
+    {
+        WorldObject* broadcaster = broadcast.Source;
 
-        for (uint32 x = cell_min.x_coord; x < cell_max.x_coord; ++x)
+        std::unordered_map<WorldObject const*, std::vector<std::pair<Player*, float>>>::iterator receivers = receiversBySource.find(broadcaster);
+        if (receivers == receiversBySource.end())
         {
-            for (uint32 y = cell_min.y_coord; y < cell_max.y_coord; ++y)
-            {
-                uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
-                if (!isCellMarked(cell_id))
-                    continue;
+            receivers = receiversBySource.emplace(broadcaster, std::vector<std::pair<Player*, float>>()).first;
+
+            // same receivers, phases and distances as MessageDistDeliverer
+            float distSq = rangeBySource[broadcaster];
+            Trinity::BroadcastReceiverCollector collector(broadcaster, distSq, receivers->second);
+            VisitWorld(broadcaster->GetPositionX(), broadcaster->GetPositionY(), std::sqrt(distSq), collector);
+        }
 
-                CellCoord pair(x, y);
-                Cell cell(pair);
-                cell.SetNoCreate();
-                Visit(cell, grid_notifier);
-                Visit(cell, world_notifier);
+        for (std::pair<Player*, float> const& receiver : receivers->second)
+        {
+            Player* player = receiver.first;
+            if (receiver.second > broadcast.DistSq || (broadcast.Team && player->GetTeam() != broadcast.Team) || player == broadcast.SkippedReceiver)
+                continue;
+
+            std::unordered_map<Player*, size_t>::iterator index = receiverIndex.find(player);
+            if (index == receiverIndex.end())
+            {
+                index = receiverIndex.emplace(player, packetsByReceiver.size()).first;
+                packetsByReceiver.emplace_back(player, std::vector<SharedPacketPtr>());
             }
+
+            packetsByReceiver[index->second].second.push_back(broadcast.Packet);
         }
     }
+
+    for (std::pair<Player*, std::vector<SharedPacketPtr>> const& receiver : packetsByReceiver)
+        if (WorldSession* session = receiver.first->GetSession())
+            session->SendPackets(receiver.second);
 }
 
 void Map::RemovePlayerFromMap(Player* player, bool remove)
 {
     sScriptMgr->OnPlayerLeaveMap(this, player);
 
+    RemovePlayerInterest(player);
     player->RemoveFromWorld();
     SendRemoveTransports(player);
 
@@ -889,6 +1326,8 @@ void Map::RemovePlayerFromMap(Player* player, bool remove)
 template<class T>
 void Map::RemoveFromMap(T *obj, bool remove)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
+
     obj->RemoveFromWorld();
     if (obj->isActiveObject())
         RemoveFromActive(obj);
@@ -951,7 +1390,10 @@ void Map::PlayerRelocation(Player* player, float x, float y, float z, float orie
 {
     ASSERT(player);
 
-    Cell old_cell(player->GetPositionX(), player->GetPositionY());
+    float oldX = player->GetPositionX();
+    float oldY = player->GetPositionY();
+
+    Cell old_cell(oldX, oldY);
     Cell new_cell(x, y);
 
     //! If hovering, always increase our server-side Z position
@@ -976,9 +1418,43 @@ void Map::PlayerRelocation(Player* player, float x, float y, float z, float orie
         AddToGrid(player, new_cell);
     }
 
+    UpdatePlayerInterest(player);
+    PrefetchGridsAhead(player, oldX, oldY);
+
     player->UpdateObjectVisibility(false);
 }
 
+void Map::PrefetchGridsAhead(Player* player, float oldX, float oldY)
+{
+    // instances share the terrain of their parent map
+    if (i_InstanceId != 0 || !sGridMapLoader->IsEnabled())
+        return;
+
+    float dx = player->GetPositionX() - oldX;
+    float dy = player->GetPositionY() - oldY;
+    float dist = std::sqrt(dx * dx + dy * dy);
+    if (dist < 0.1f)
+        return;
+
+    // look a bit further than the grids that get loaded for visibility
+    float lookahead = GetVisibilityRange() + SIZE_OF_GRIDS / 2;
+    float x = player->GetPositionX() + dx / dist * lookahead;
+    float y = player->GetPositionY() + dy / dist * lookahead;
+    if (!Trinity::IsValidMapCoord(x, y))
+        return;
+
+    GridCoord p = Trinity::ComputeGridCoord(x, y);
+    uint32 gx = (MAX_NUMBER_OF_GRIDS - 1) - p.x_coord;
+    uint32 gy = (MAX_NUMBER_OF_GRIDS - 1) - p.y_coord;
+
+    // same lock EnsureGridCreated loads GridMaps under
+    std::lock_guard<std::mutex> lock(_gridLock);
+    if (GridMaps[gx][gy])
+        return;
+
+    sGridMapLoader->Prefetch(GetId(), gx, gy);
+}
+
 void Map::CreatureRelocation(Creature* creature, float x, float y, float z, float ang, bool respawnRelocationOnFail)
 {
     ASSERT(CheckGridIntegrity(creature, false));
@@ -1083,6 +1559,8 @@ void Map::DynamicObjectRelocation(DynamicObject* dynObj, float x, float y, float
 
 void Map::AddCreatureToMoveList(Creature* c, float x, float y, float z, float ang)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
+
     if (_creatureToMoveLock) //can this happen?
         return;
 
@@ -1093,6 +1571,8 @@ void Map::AddCreatureToMoveList(Creature* c, float x, float y, float z, float an
 
 void Map::RemoveCreatureFromMoveList(Creature* c)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
+
     if (_creatureToMoveLock) //can this happen?
         return;
 
@@ -1102,6 +1582,8 @@ void Map::RemoveCreatureFromMoveList(Creature* c)
 
 void Map::AddGameObjectToMoveList(GameObject* go, float x, float y, float z, float ang)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
+
     if (_gameObjectsToMoveLock) //can this happen?
         return;
 
@@ -1112,6 +1594,8 @@ void Map::AddGameObjectToMoveList(GameObject* go, float x, float y, float z, flo
 
 void Map::RemoveGameObjectFromMoveList(GameObject* go)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
+
     if (_gameObjectsToMoveLock) //can this happen?
         return;
 
@@ -1121,6 +1605,8 @@ void Map::RemoveGameObjectFromMoveList(GameObject* go)
 
 void Map::AddDynamicObjectToMoveList(DynamicObject* dynObj, float x, float y, float z, float ang)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
+
     if (_dynamicObjectsToMoveLock) //can this happen?
         return;
 
@@ -1131,6 +1617,8 @@ void Map::AddDynamicObjectToMoveList(DynamicObject* dynObj, float x, float y, fl
 
 void Map::RemoveDynamicObjectFromMoveList(DynamicObject* dynObj)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
+
     if (_dynamicObjectsToMoveLock) //can this happen?
         return;
 
@@ -1214,12 +1702,14 @@ void Map::MoveAllGameObjectsInMoveList()
             continue;
 
         // do move or do move to respawn or remove creature if previous all fail
+        CellCoord oldCell = go->GetCurrentCell().GetCellCoord();
         if (GameObjectCellRelocation(go, Cell(go->_newPosition.m_positionX, go->_newPosition.m_positionY)))
         {
             // update pos
             go->Relocate(go->_newPosition);
             go->UpdateModelPosition();
             go->UpdateObjectVisibility(false);
+            UpdateVisibilityForLeftObservers(go, oldCell);
         }
         else
         {
@@ -1259,11 +1749,13 @@ void Map::MoveAllDynamicObjectsInMoveList()
             continue;
 
         // do move or do move to respawn or remove creature if previous all fail
+        CellCoord oldCell = dynObj->GetCurrentCell().GetCellCoord();
         if (DynamicObjectCellRelocation(dynObj, Cell(dynObj->_newPosition.m_positionX, dynObj->_newPosition.m_positionY)))
         {
             // update pos
             dynObj->Relocate(dynObj->_newPosition);
             dynObj->UpdateObjectVisibility(false);
+            UpdateVisibilityForLeftObservers(dynObj, oldCell);
         }
         else
         {
@@ -1645,11 +2137,114 @@ void Map::UnloadAll()
     _corpsesByCell.clear();
     _corpsesByPlayer.clear();
     _corpseBones.clear();
+
+    SaveRespawnTransaction();
 }
 
 // *****************************
 // Grid function
 // *****************************
+// reads a .map file either with stdio or from a read-only mapping of the whole file
+class GridMapFile
+{
+    public:
+        GridMapFile() : _file(NULL), _data(NULL), _size(0), _pos(0) { }
+        ~GridMapFile()
+        {
+            if (_file)
+                fclose(_file);
+        }
+
+        // returns false if the file does not exist, the mapping (if any) is owned by the caller
+        bool Open(char const* filename, bool mapped)
+        {
+#if PLATFORM != PLATFORM_WINDOWS
+            if (mapped)
+            {
+                int fd = open(filename, O_RDONLY);
+                if (fd < 0)
+                    return false;
+
+                struct stat st;
+                if (fstat(fd, &st) == 0 && st.st_size > 0)
+                {
+                    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+                    if (data != MAP_FAILED)
+                    {
+                        _data = static_cast<uint8*>(data);
+                        _size = st.st_size;
+                    }
+                }
+
+                close(fd);
+                if (_data)
+                    return true;
+            }
+#else
+            (void)mapped;
+#endif
+            _file = fopen(filename, "rb");
+            return _file != NULL;
+        }
+
+        void* GetMappedData() const { return _data; }
+        size_t GetMappedSize() const { return _size; }
+
+        void Seek(uint32 offset)
+        {
+            if (_data)
+                _pos = offset;
+            else
+                fseek(_file, offset, SEEK_SET);
+        }
+
+        template<class T>
+        bool Read(T& value)
+        {
+            if (!_data)
+                return fread(&value, sizeof(T), 1, _file) == 1;
+
+            if (_pos + sizeof(T) > _size)
+                return false;
+
+            memcpy(&value, _data + _pos, sizeof(T));
+            _pos += sizeof(T);
+            return true;
+        }
+
+        // points data into the mapping when it is suitably aligned, otherwise allocates a copy
+        template<class T>
+        bool ReadArray(T*& data, uint32 count)
+        {
+            if (!_data)
+            {
+                data = new T[count];
+                return fread(data, sizeof(T), count, _file) == count;
+            }
+
+            if (_pos + sizeof(T) * count > _size)
+                return false;
+
+            uint8* src = _data + _pos;
+            _pos += sizeof(T) * count;
+            if (reinterpret_cast<uintptr_t>(src) % sizeof(T) == 0)
+            {
+                data = reinterpret_cast<T*>(src);
+                return true;
+            }
+
+            data = new T[count];
+            memcpy(data, src, sizeof(T) * count);
+            return true;
+        }
+
+    private:
+        FILE* _file;
+        uint8* _data;
+        size_t _size;
+        size_t _pos;
+};
+
 GridMap::GridMap()
 {
     _flags = 0;
@@ -1672,6 +2267,8 @@ GridMap::GridMap()
     _liquidEntry = NULL;
     _liquidFlags = NULL;
     _liquidMap  = NULL;
+    _mappedData = NULL;
+    _mappedSize = 0;
 }
 
 GridMap::~GridMap()
@@ -1686,15 +2283,16 @@ bool GridMap::loadData(const char* filename)
 
     map_fileheader header;
     // Not return error if file not found
-    FILE* in = fopen(filename, "rb");
-    if (!in)
+    GridMapFile in;
+    if (!in.Open(filename, sWorld->getBoolConfig(CONFIG_MAP_FILES_MEMORY_MAPPED)))
         return true;
 
-    if (fread(&header, sizeof(header), 1, in) != 1)
-    {
-        fclose(in);
+    // the mapping stays alive until unloadData
+    _mappedData = in.GetMappedData();
+    _mappedSize = in.GetMappedSize();
+
+    if (!in.Read(header))
         return false;
-    }
 
     if (header.mapMagic.asUInt == MapMagic.asUInt && header.versionMagic.asUInt == MapVersionMagic.asUInt)
     {
@@ -1702,74 +2300,85 @@ bool GridMap::loadData(const char* filename)
         if (header.areaMapOffset && !loadAreaData(in, header.areaMapOffset, header.areaMapSize))
         {
             TC_LOG_ERROR("maps", "Error loading map area data\n");
-            fclose(in);
             return false;
         }
         // load up height data
         if (header.heightMapOffset && !loadHeightData(in, header.heightMapOffset, header.heightMapSize))
         {
             TC_LOG_ERROR("maps", "Error loading map height data\n");
-            fclose(in);
             return false;
         }
         // load up liquid data
         if (header.liquidMapOffset && !loadLiquidData(in, header.liquidMapOffset, header.liquidMapSize))
         {
             TC_LOG_ERROR("maps", "Error loading map liquids data\n");
-            fclose(in);
             return false;
         }
-        fclose(in);
         return true;
     }
 
     TC_LOG_ERROR("maps", "Map file '%s' is from an incompatible map version (%.*s %.*s), %.*s %.*s is expected. Please recreate using the mapextractor.",
         filename, 4, header.mapMagic.asChar, 4, header.versionMagic.asChar, 4, MapMagic.asChar, 4, MapVersionMagic.asChar);
-    fclose(in);
     return false;
 }
 
 void GridMap::unloadData()
 {
-    delete[] _areaMap;
-    delete[] m_V9;
-    delete[] m_V8;
-    delete[] _liquidEntry;
-    delete[] _liquidFlags;
-    delete[] _liquidMap;
-    _areaMap = NULL;
-    m_V9 = NULL;
-    m_V8 = NULL;
-    _liquidEntry = NULL;
-    _liquidFlags = NULL;
-    _liquidMap  = NULL;
+    freeArray(_areaMap);
+    freeArray(m_V9);
+    freeArray(m_V8);
+    freeArray(_liquidEntry);
+    freeArray(_liquidFlags);
+    freeArray(_liquidMap);
     _gridGetHeight = &GridMap::getHeightFromFlat;
+
+#if PLATFORM != PLATFORM_WINDOWS
+    if (_mappedData)
+        munmap(_mappedData, _mappedSize);
+#endif
+    _mappedData = NULL;
+    _mappedSize = 0;
 }
 
-bool GridMap::loadAreaData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::isMapped(void const* data) const
+{
+    uint8 const* begin = static_cast<uint8 const*>(_mappedData);
+    uint8 const* ptr = static_cast<uint8 const*>(data);
+    return _mappedData && ptr >= begin && ptr < begin + _mappedSize;
+}
+
+template<class T>
+void GridMap::freeArray(T*& data)
+{
+    if (!isMapped(data))
+        delete[] data;
+
+    data = NULL;
+}
+
+bool GridMap::loadAreaData(GridMapFile& in, uint32 offset, uint32 /*size*/)
 {
     map_areaHeader header;
-    fseek(in, offset, SEEK_SET);
+    in.Seek(offset);
 
-    if (fread(&header, sizeof(header), 1, in) != 1 || header.fourcc != MapAreaMagic.asUInt)
+    if (!in.Read(header) || header.fourcc != MapAreaMagic.asUInt)
         return false;
 
     _gridArea = header.gridArea;
     if (!(header.flags & MAP_AREA_NO_AREA))
     {
-        _areaMap = new uint16 [16*16];
-        if (fread(_areaMap, sizeof(uint16), 16*16, in) != 16*16)
+        if (!in.ReadArray(_areaMap, 16*16))
             return false;
     }
     return true;
 }
 
-bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadHeightData(GridMapFile& in, uint32 offset, uint32 /*size*/)
 {
     map_heightHeader header;
-    fseek(in, offset, SEEK_SET);
+    in.Seek(offset);
 
-    if (fread(&header, sizeof(header), 1, in) != 1 || header.fourcc != MapHeightMagic.asUInt)
+    if (!in.Read(header) || header.fourcc != MapHeightMagic.asUInt)
         return false;
 
     _gridHeight = header.gridHeight;
@@ -1777,30 +2386,24 @@ bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
     {
         if ((header.flags & MAP_HEIGHT_AS_INT16))
         {
-            m_uint16_V9 = new uint16 [129*129];
-            m_uint16_V8 = new uint16 [128*128];
-            if (fread(m_uint16_V9, sizeof(uint16), 129*129, in) != 129*129 ||
-                fread(m_uint16_V8, sizeof(uint16), 128*128, in) != 128*128)
+            if (!in.ReadArray(m_uint16_V9, 129*129) ||
+                !in.ReadArray(m_uint16_V8, 128*128))
                 return false;
             _gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 65535;
             _gridGetHeight = &GridMap::getHeightFromUint16;
         }
         else if ((header.flags & MAP_HEIGHT_AS_INT8))
         {
-            m_uint8_V9 = new uint8 [129*129];
-            m_uint8_V8 = new uint8 [128*128];
-            if (fread(m_uint8_V9, sizeof(uint8), 129*129, in) != 129*129 ||
-                fread(m_uint8_V8, sizeof(uint8), 128*128, in) != 128*128)
+            if (!in.ReadArray(m_uint8_V9, 129*129) ||
+                !in.ReadArray(m_uint8_V8, 128*128))
                 return false;
             _gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 255;
             _gridGetHeight = &GridMap::getHeightFromUint8;
         }
         else
         {
-            m_V9 = new float [129*129];
-            m_V8 = new float [128*128];
-            if (fread(m_V9, sizeof(float), 129*129, in) != 129*129 ||
-                fread(m_V8, sizeof(float), 128*128, in) != 128*128)
+            if (!in.ReadArray(m_V9, 129*129) ||
+                !in.ReadArray(m_V8, 128*128))
                 return false;
             _gridGetHeight = &GridMap::getHeightFromFloat;
         }
@@ -1810,12 +2413,12 @@ bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
     return true;
 }
 
-bool GridMap::loadLiquidData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadLiquidData(GridMapFile& in, uint32 offset, uint32 /*size*/)
 {
     map_liquidHeader header;
-    fseek(in, offset, SEEK_SET);
+    in.Seek(offset);
 
-    if (fread(&header, sizeof(header), 1, in) != 1 || header.fourcc != MapLiquidMagic.asUInt)
+    if (!in.Read(header) || header.fourcc != MapLiquidMagic.asUInt)
         return false;
 
     _liquidType   = header.liquidType;
@@ -1827,18 +2430,15 @@ bool GridMap::loadLiquidData(FILE* in, uint32 offset, uint32 /*size*/)
 
     if (!(header.flags & MAP_LIQUID_NO_TYPE))
     {
-        _liquidEntry = new uint16[16*16];
-        if (fread(_liquidEntry, sizeof(uint16), 16*16, in) != 16*16)
+        if (!in.ReadArray(_liquidEntry, 16*16))
             return false;
 
-        _liquidFlags = new uint8[16*16];
-        if (fread(_liquidFlags, sizeof(uint8), 16*16, in) != 16*16)
+        if (!in.ReadArray(_liquidFlags, 16*16))
             return false;
     }
     if (!(header.flags & MAP_LIQUID_NO_HEIGHT))
     {
-        _liquidMap = new float[uint32(_liquidWidth) * uint32(_liquidHeight)];
-        if (fread(_liquidMap, sizeof(float), _liquidWidth*_liquidHeight, in) != (uint32(_liquidWidth) * uint32(_liquidHeight)))
+        if (!in.ReadArray(_liquidMap, uint32(_liquidWidth) * uint32(_liquidHeight)))
             return false;
     }
     return true;
@@ -2682,16 +3282,40 @@ void Map::SendObjectUpdates()
         obj->BuildUpdate(update_players);
     }
 
-    WorldPacket packet;                                     // here we allocate a std::vector with a size of 0x10000
-    for (UpdateDataMapType::iterator iter = update_players.begin(); iter != update_players.end(); ++iter)
+    // every receiver gets exactly one packet, so receivers can be built and sent from different threads
+    std::vector<UpdateDataMapType::value_type*> receivers;
+    receivers.reserve(update_players.size());
+    for (UpdateDataMapType::value_type& receiver : update_players)
+        receivers.push_back(&receiver);
+
+    auto sendUpdates = [&receivers](size_t begin, size_t end)
+    {
+        WorldPacket packet;                                 // here we allocate a std::vector with a size of 0x10000
+        for (size_t i = begin; i < end; ++i)
+        {
+            receivers[i]->second.BuildPacket(&packet);
+            receivers[i]->first->GetSession()->SendPacket(&packet);
+            packet.clear();                                 // clean the string
+        }
+    };
+
+    if (receivers.size() <= OBJECT_UPDATE_RECEIVERS_PER_TASK || !sMapMgr->GetMapUpdater()->activated())
+    {
+        sendUpdates(0, receivers.size());
+        return;
+    }
+
+    std::vector<std::function<void()>> tasks;
+    for (size_t begin = 0; begin < receivers.size(); begin += OBJECT_UPDATE_RECEIVERS_PER_TASK)
     {
-        iter->second.BuildPacket(&packet);
-        iter->first->GetSession()->SendPacket(&packet);
-        packet.clear();                                     // clean the string
+        size_t end = std::min<size_t>(begin + OBJECT_UPDATE_RECEIVERS_PER_TASK, receivers.size());
+        tasks.push_back([&sendUpdates, begin, end]() { sendUpdates(begin, end); });
     }
+
+    sMapMgr->GetMapUpdater()->run_parallel(tasks);
 }
 
-void Map::DelayedUpdate(const uint32 t_diff)
+void Map::DelayedUpdateTransports(const uint32 t_diff)
 {
     for (_transportsUpdateIter = _transports.begin(); _transportsUpdateIter != _transports.end();)
     {
@@ -2703,7 +3327,10 @@ void Map::DelayedUpdate(const uint32 t_diff)
 
         transport->DelayedUpdate(t_diff);
     }
+}
 
+void Map::DelayedUpdate(const uint32 t_diff)
+{
     RemoveAllObjectsInRemoveList();
 
     // Don't unload grids if it's battleground, since we may have manually added GOs, creatures, those doesn't load from DB at grid re-load !
@@ -2727,6 +3354,7 @@ void Map::AddObjectToRemoveList(WorldObject* obj)
 
     obj->CleanupsBeforeDelete(false);                            // remove or simplify at least cross referenced links
 
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
     i_objectsToRemove.insert(obj);
     //TC_LOG_DEBUG("maps", "Object (GUID: %u TypeId: %u) added to removing list.", obj->GetGUIDLow(), obj->GetTypeId());
 }
@@ -2739,6 +3367,7 @@ void Map::AddObjectToSwitchList(WorldObject* obj, bool on)
     if (obj->GetTypeId() != TYPEID_UNIT && obj->GetTypeId() != TYPEID_GAMEOBJECT)
         return;
 
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
     std::map<WorldObject*, bool>::iterator itr = i_objectsToSwitch.find(obj);
     if (itr == i_objectsToSwitch.end())
         i_objectsToSwitch.insert(itr, std::make_pair(obj, on));
@@ -2953,6 +3582,54 @@ template void Map::RemoveFromMap(AreaTrigger*, bool);
 
 /* ******* Dungeon Instance Maps ******* */
 
+// the grid and cell tables are part of the map object, so an instance map is a large allocation
+static std::mutex InstanceMapPoolLock;
+static std::vector<void*> InstanceMapPool;
+
+void* InstanceMap::operator new(size_t size)
+{
+    if (size == sizeof(InstanceMap))
+    {
+        std::lock_guard<std::mutex> lock(InstanceMapPoolLock);
+        if (!InstanceMapPool.empty())
+        {
+            void* ptr = InstanceMapPool.back();
+            InstanceMapPool.pop_back();
+            return ptr;
+        }
+    }
+
+    return ::operator new(size);
+}
+
+void InstanceMap::operator delete(void* ptr, size_t size)
+{
+    if (size == sizeof(InstanceMap))
+    {
+        std::lock_guard<std::mutex> lock(InstanceMapPoolLock);
+        if (InstanceMapPool.size() < sWorld->getIntConfig(CONFIG_INSTANCE_MAP_POOL_SIZE))
+        {
+#ifdef TRINITY_DEBUG
+            // the allocator no longer sees this memory, make a use after free of the destroyed map crash instead of reading stale data
+            memset(ptr, 0xDD, size);
+#endif
+            InstanceMapPool.push_back(ptr);
+            return;
+        }
+    }
+
+    ::operator delete(ptr);
+}
+
+void InstanceMap::ClearPool()
+{
+    std::lock_guard<std::mutex> lock(InstanceMapPoolLock);
+    for (void* ptr : InstanceMapPool)
+        ::operator delete(ptr);
+
+    InstanceMapPool.clear();
+}
+
 InstanceMap::InstanceMap(uint32 id, time_t expiry, uint32 InstanceId, uint8 SpawnMode, Map* _parent)
   : Map(id, expiry, InstanceId, SpawnMode, _parent),
     m_resetAfterUnload(false), m_unloadWhenEmpty(false),
@@ -3498,6 +4175,7 @@ void Map::SaveCreatureRespawnTime(ObjectGuid::LowType dbGuid, time_t respawnTime
         return;
     }
 
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
     _creatureRespawnTimes[dbGuid] = respawnTime;
 
     PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_REP_CREATURE_RESPAWN);
@@ -3505,18 +4183,19 @@ void Map::SaveCreatureRespawnTime(ObjectGuid::LowType dbGuid, time_t respawnTime
     stmt->setUInt32(1, uint32(respawnTime));
     stmt->setUInt16(2, GetId());
     stmt->setUInt32(3, GetInstanceId());
-    CharacterDatabase.Execute(stmt);
+    AppendRespawnStatement(stmt);
 }
 
 void Map::RemoveCreatureRespawnTime(ObjectGuid::LowType dbGuid)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
     _creatureRespawnTimes.erase(dbGuid);
 
     PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_CREATURE_RESPAWN);
     stmt->setUInt64(0, dbGuid);
     stmt->setUInt16(1, GetId());
     stmt->setUInt32(2, GetInstanceId());
-    CharacterDatabase.Execute(stmt);
+    AppendRespawnStatement(stmt);
 }
 
 void Map::SaveGORespawnTime(ObjectGuid::LowType dbGuid, time_t respawnTime)
@@ -3528,6 +4207,7 @@ void Map::SaveGORespawnTime(ObjectGuid::LowType dbGuid, time_t respawnTime)
         return;
     }
 
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
     _goRespawnTimes[dbGuid] = respawnTime;
 
     PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_REP_GO_RESPAWN);
@@ -3535,18 +4215,19 @@ void Map::SaveGORespawnTime(ObjectGuid::LowType dbGuid, time_t respawnTime)
     stmt->setUInt32(1, uint32(respawnTime));
     stmt->setUInt16(2, GetId());
     stmt->setUInt32(3, GetInstanceId());
-    CharacterDatabase.Execute(stmt);
+    AppendRespawnStatement(stmt);
 }
 
 void Map::RemoveGORespawnTime(ObjectGuid::LowType dbGuid)
 {
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
     _goRespawnTimes.erase(dbGuid);
 
     PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_GO_RESPAWN);
     stmt->setUInt64(0, dbGuid);
     stmt->setUInt16(1, GetId());
     stmt->setUInt32(2, GetInstanceId());
-    CharacterDatabase.Execute(stmt);
+    AppendRespawnStatement(stmt);
 }
 
 void Map::LoadRespawnTimes()
@@ -3586,6 +4267,7 @@ void Map::DeleteRespawnTimes()
 {
     _creatureRespawnTimes.clear();
     _goRespawnTimes.clear();
+    _respawnTransaction.reset();
 
     DeleteRespawnTimesInDB(GetId(), GetInstanceId());
 }
@@ -3603,6 +4285,80 @@ void Map::DeleteRespawnTimesInDB(uint16 mapId, uint32 instanceId)
     CharacterDatabase.Execute(stmt);
 }
 
+void Map::AppendRespawnStatement(PreparedStatement* stmt)
+{
+    if (!_respawnTransaction)
+        _respawnTransaction = CharacterDatabase.BeginTransaction();
+
+    _respawnTransaction->Append(stmt);
+}
+
+void Map::SaveRespawnTransaction()
+{
+    if (!_respawnTransaction)
+        return;
+
+    CharacterDatabase.CommitTransaction(_respawnTransaction);
+    _respawnTransaction.reset();
+}
+
+void Map::ScheduleRespawn(ObjectGuid const& guid, time_t respawnTime)
+{
+    // an earlier or later time is a new entry, the old one no longer matches the creature's scheduled time and is dropped when due
+    std::unique_lock<std::recursive_mutex> lock = LockRegions();
+    _respawnQueue.emplace(guid, respawnTime);
+}
+
+void Map::ProcessRespawns()
+{
+    time_t now = time(NULL);
+
+    // entries rescheduled while processing wait for the next update
+    std::vector<ScheduledRespawn> dueRespawns;
+    while (!_respawnQueue.empty() && _respawnQueue.top().RespawnTime <= now)
+    {
+        dueRespawns.push_back(_respawnQueue.top());
+        _respawnQueue.pop();
+    }
+
+    for (ScheduledRespawn const& respawn : dueRespawns)
+    {
+        Creature* creature = GetCreature(respawn.Guid);
+        if (!creature || !creature->IsInWorld() || creature->getDeathState() != DEAD || creature->GetScheduledRespawnTime() != respawn.RespawnTime)
+            continue;
+
+        creature->UpdateRespawn(now);
+    }
+
+    SaveRespawnTransaction();
+}
+
+void Map::GetPendingRespawns(uint32 zoneId, std::vector<PendingRespawn>& respawns) const
+{
+    for (std::pair<ObjectGuid::LowType const, time_t> const& respawn : _creatureRespawnTimes)
+    {
+        CreatureData const* data = sObjectMgr->GetCreatureData(respawn.first);
+        if (!data || GetZoneId(data->posX, data->posY, data->posZ) != zoneId)
+            continue;
+
+        respawns.push_back({ ObjectGuid::Create<HighGuid::Creature>(GetId(), data->id, respawn.first), respawn.second });
+    }
+
+    for (std::pair<ObjectGuid::LowType const, time_t> const& respawn : _goRespawnTimes)
+    {
+        GameObjectData const* data = sObjectMgr->GetGOData(respawn.first);
+        if (!data || GetZoneId(data->posX, data->posY, data->posZ) != zoneId)
+            continue;
+
+        respawns.push_back({ ObjectGuid::Create<HighGuid::GameObject>(GetId(), data->id, respawn.first), respawn.second });
+    }
+
+    std::sort(respawns.begin(), respawns.end(), [](PendingRespawn const& left, PendingRespawn const& right)
+    {
+        return left.RespawnTime < right.RespawnTime;
+    });
+}
+
 time_t Map::GetLinkedRespawnTime(ObjectGuid guid) const
 {
     ObjectGuid linkedGuid = sObjectMgr->GetLinkedRespawnGuid(guid);
@@ -31,13 +31,16 @@
 #include "DynamicTree.h"
 #include "GameObjectModel.h"
 #include "ObjectGuid.h"
+#include "Transaction.h"
+#include "SharedPacket.h"
 
 #include <bitset>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <queue>
 
 class Unit;
-class WorldPacket;
 class InstanceScript;
 class Group;
 class InstanceSave;
@@ -54,6 +57,7 @@ class MapInstanced;
 class BattlegroundMap;
 class InstanceMap;
 class Transport;
+class GridMapFile;
 enum WeatherState : uint32;
 
 namespace Trinity { struct ObjectUpdater; }
@@ -187,10 +191,17 @@ class GridMap
     uint8 _liquidWidth;
     uint8 _liquidHeight;
 
+    // read-only mapping of the .map file, arrays above point into it when their data is aligned
+    void* _mappedData;
+    size_t _mappedSize;
 
-    bool loadAreaData(FILE* in, uint32 offset, uint32 size);
-    bool loadHeightData(FILE* in, uint32 offset, uint32 size);
-    bool loadLiquidData(FILE* in, uint32 offset, uint32 size);
+    bool loadAreaData(GridMapFile& in, uint32 offset, uint32 size);
+    bool loadHeightData(GridMapFile& in, uint32 offset, uint32 size);
+    bool loadLiquidData(GridMapFile& in, uint32 offset, uint32 size);
+
+    bool isMapped(void const* data) const;
+    template<class T>
+    void freeArray(T*& data);
 
     // Get height functions and pointers
     typedef float (GridMap::*GetHeightPtr) (float x, float y) const;
@@ -279,9 +290,18 @@ class Map : public GridRefManager<NGridType>
         template<class T> bool AddToMap(T *);
         template<class T> void RemoveFromMap(T *, bool);
 
-        void VisitNearbyCellsOf(WorldObject* obj, TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer> &gridVisitor, TypeContainerVisitor<Trinity::ObjectUpdater, WorldTypeMapContainer> &worldVisitor);
         virtual void Update(const uint32);
 
+        // smoothed wall time of the last updates in microseconds, used by MapUpdater to dispatch expensive maps first
+        uint32 GetUpdateCost() const { return _updateCost; }
+        void RecordUpdateCost(uint32 cost) { _updateCost = (_updateCost * 3 + cost) / 4; }
+
+        // objects and grids of maps without activity are updated less often than MapUpdateInterval, diff is accumulated
+        // until the map is due. Sessions are updated every tick regardless
+        bool IsUpdateDue(uint32 diff, uint32& updateDiff);
+        uint32 GetUpdateInterval() const { return _updateInterval; }
+        void ResetUpdateInterval() { _updateInterval = 0; }
+
         float GetVisibilityRange() const { return m_VisibleDistance; }
         //function for setting up visibility distance for maps on per-type/per-Id basis
         virtual void InitVisibilityDistance();
@@ -404,6 +424,8 @@ class Map : public GridRefManager<NGridType>
 
         void AddObjectToRemoveList(WorldObject* obj);
         void AddObjectToSwitchList(WorldObject* obj, bool on);
+        // transports may teleport to other maps, so unlike DelayedUpdate this is never run in parallel
+        virtual void DelayedUpdateTransports(const uint32 diff);
         virtual void DelayedUpdate(const uint32 diff);
 
         void UpdateObjectVisibility(WorldObject* obj, Cell cell, CellCoord cellpair);
@@ -530,6 +552,17 @@ class Map : public GridRefManager<NGridType>
         void LoadRespawnTimes();
         void DeleteRespawnTimes();
 
+        // dead creature is respawned by the map once respawnTime passed
+        void ScheduleRespawn(ObjectGuid const& guid, time_t respawnTime);
+
+        struct PendingRespawn
+        {
+            ObjectGuid SpawnGuid;                               // same form as linked respawn guids
+            time_t RespawnTime;
+        };
+
+        void GetPendingRespawns(uint32 zoneId, std::vector<PendingRespawn>& respawns) const;
+
         void LoadCorpseData();
         void DeleteCorpseData();
         void AddCorpse(Corpse* corpse);
@@ -550,23 +583,52 @@ class Map : public GridRefManager<NGridType>
 
         void UpdateAreaDependentAuras();
 
+        // outside of the parallel region passes the map thread is alone with its containers, the lock is not taken
+        std::unique_lock<std::recursive_mutex> LockRegions()
+        {
+            std::unique_lock<std::recursive_mutex> lock(_regionLock, std::defer_lock);
+            if (_updatingRegions)
+                lock.lock();
+            return lock;
+        }
+
         template<HighGuid high>
         inline ObjectGuid::LowType GenerateLowGuid()
         {
             static_assert(ObjectGuidTraits<high>::MapSpecific, "Only map specific guid can be generated in Map context");
+            std::unique_lock<std::recursive_mutex> lock = LockRegions();
             return GetGuidSequenceGenerator<high>().Generate();
         }
 
         void AddUpdateObject(Object* obj)
         {
+            std::unique_lock<std::recursive_mutex> lock = LockRegions();
             _updateObjects.insert(obj);
         }
 
         void RemoveUpdateObject(Object* obj)
         {
+            std::unique_lock<std::recursive_mutex> lock = LockRegions();
             _updateObjects.erase(obj);
         }
 
+        // units whose visibility changed, handled by the next ProcessRelocationNotifies
+        void AddUnitToNotify(Unit* unit);
+        void RemoveUnitFromNotify(Unit* unit);
+
+        // interest management: players observe the cells their view point sees into
+        void UpdatePlayerInterest(Player* player);
+        void RemovePlayerInterest(Player* player);
+        // visibility of the object for the players observing its cell
+        void UpdateVisibilityForObservers(WorldObject* obj);
+        // after a cell border crossing, players that observed only the old cell lose the object
+        void UpdateVisibilityForLeftObservers(WorldObject* obj, CellCoord const& oldCell);
+
+        // broadcasts sent while the map updates are delivered in batches, receivers are resolved once per source
+        bool IsBatchingBroadcasts() const { return _batchBroadcasts; }
+        void QueueBroadcast(WorldObject* source, WorldPacket const* data, float dist, bool ownTeamOnly, Player const* skipped);
+        void DeliverBroadcasts(WorldObject const* source = nullptr);
+
     private:
         void LoadMapAndVMap(int gx, int gy);
         void LoadVMap(int gx, int gy);
@@ -621,6 +683,32 @@ class Map : public GridRefManager<NGridType>
 
         void UpdateActiveCells(const float &x, const float &y, const uint32 t_diff);
 
+        struct ActiveCell
+        {
+            ActiveCell(CellCoord const& coord) : Coord(coord), Observed(true) { }
+
+            CellCoord Coord;
+            bool Observed;                                  // false lets idle creatures of the cell hibernate
+        };
+
+        // a grid worth of cells updated by one task when the map is updated in parallel regions
+        struct MapRegion
+        {
+            std::vector<ActiveCell> Cells;
+            std::vector<Creature*> SerialCreatures;         // left out of the parallel pass, updated afterwards by the map thread
+        };
+
+        virtual uint32 CalculateUpdateInterval() const;
+
+        // builds _activeCells from the cells around players, creatures they fight and active objects
+        void CollectActiveCells();
+        void AddActiveCellsAround(WorldObject const* obj);
+
+        void UpdateActiveObjects(const uint32 t_diff);
+        bool CanUpdateInRegions() const;
+        void UpdateInRegions(const uint32 t_diff);
+        void UpdateRegion(MapRegion& region, const uint32 t_diff);
+
         void SendObjectUpdates();
 
     protected:
@@ -630,6 +718,10 @@ class Map : public GridRefManager<NGridType>
         std::mutex _mapLock;
         std::mutex _gridLock;
 
+        // guards map wide containers (update, move and remove lists, object stores) while regions are updated in parallel
+        std::recursive_mutex _regionLock;
+        bool _updatingRegions;                              // set by the map thread around the parallel passes only
+
         MapEntry const* i_mapEntry;
         uint8 i_spawnMode;
         uint32 i_InstanceId;
@@ -675,6 +767,9 @@ class Map : public GridRefManager<NGridType>
         //visibility calculations. Highly optimized for massive calculations
         void ProcessRelocationNotifies(const uint32 diff);
 
+        // queues the terrain of the grid the player is heading to on the prefetch threads
+        void PrefetchGridsAhead(Player* player, float oldX, float oldY);
+
         bool i_scriptLock;
         std::set<WorldObject*> i_objectsToRemove;
         std::map<WorldObject*, bool> i_objectsToSwitch;
@@ -692,11 +787,14 @@ class Map : public GridRefManager<NGridType>
 
         void AddToActiveHelper(WorldObject* obj)
         {
+            std::unique_lock<std::recursive_mutex> lock = LockRegions();
             m_activeNonPlayers.insert(obj);
         }
 
         void RemoveFromActiveHelper(WorldObject* obj)
         {
+            std::unique_lock<std::recursive_mutex> lock = LockRegions();
+
             // Map::Update for active object in proccess
             if (m_activeNonPlayersIter != m_activeNonPlayers.end())
             {
@@ -714,6 +812,25 @@ class Map : public GridRefManager<NGridType>
         std::unordered_map<ObjectGuid::LowType /*dbGUID*/, time_t> _creatureRespawnTimes;
         std::unordered_map<ObjectGuid::LowType /*dbGUID*/, time_t> _goRespawnTimes;
 
+        struct ScheduledRespawn
+        {
+            ScheduledRespawn(ObjectGuid const& guid, time_t respawnTime) : Guid(guid), RespawnTime(respawnTime) { }
+
+            ObjectGuid Guid;
+            time_t RespawnTime;
+
+            bool operator>(ScheduledRespawn const& right) const { return RespawnTime > right.RespawnTime; }
+        };
+
+        // entries of creatures that were removed, respawned or rescheduled since are skipped when due
+        std::priority_queue<ScheduledRespawn, std::vector<ScheduledRespawn>, std::greater<ScheduledRespawn>> _respawnQueue;
+        // respawn time changes of one update are written in a single transaction
+        SQLTransaction _respawnTransaction;
+
+        void ProcessRespawns();
+        void AppendRespawnStatement(PreparedStatement* stmt);
+        void SaveRespawnTransaction();
+
         ZoneDynamicInfoMap _zoneDynamicInfo;
         uint32 _defaultLight;
 
@@ -736,6 +853,37 @@ class Map : public GridRefManager<NGridType>
         std::unordered_set<Corpse*> _corpseBones;
 
         std::unordered_set<Object*> _updateObjects;
+
+        uint32 _updateCost;
+        uint32 _updateInterval;
+        uint32 _pendingUpdateDiff;
+
+        // cells updated this tick, each cell once, in grid order
+        std::vector<ActiveCell> _activeCells;
+
+        // units flagged with NOTIFY_VISIBILITY_CHANGED, so relocation notifies only touch what moved
+        PeriodicTimer _relocationNotifyTimer;
+        std::vector<Unit*> _unitsToNotify;
+        std::vector<Unit*> _unitsInNotify;             // units of the running relocation pass
+
+        std::unordered_map<uint32 /*cellId*/, std::vector<Player*>> _cellObservers;
+        std::unordered_map<Player*, CellArea> _observedAreas;
+
+        struct QueuedBroadcast
+        {
+            QueuedBroadcast(WorldObject* source, SharedPacketPtr&& packet, float distSq, uint32 team, Player const* skipped)
+                : Source(source), Packet(std::move(packet)), DistSq(distSq), Team(team), SkippedReceiver(skipped) { }
+
+            WorldObject* Source;
+            SharedPacketPtr Packet;
+            float DistSq;
+            uint32 Team;
+            Player const* SkippedReceiver;
+        };
+
+        bool _batchBroadcasts;
+        std::vector<QueuedBroadcast> _broadcasts;
+        std::unordered_map<WorldObject const*, uint32> _broadcastCounts;
 };
 
 enum InstanceResetMethod
@@ -770,6 +918,12 @@ class InstanceMap : public Map
         uint32 GetMaxResetDelay() const;
 
         virtual void InitVisibilityDistance() override;
+
+        // memory of destroyed instance maps is kept for the next instance, up to Instance.MapPoolSize maps
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr, size_t size);
+        static void ClearPool();
+
     private:
         bool m_resetAfterUnload;
         bool m_unloadWhenEmpty;
@@ -74,12 +74,24 @@ void MapInstanced::Update(const uint32 t)
     }
 }
 
-void MapInstanced::DelayedUpdate(const uint32 diff)
+void MapInstanced::DelayedUpdateTransports(const uint32 diff)
 {
     for (InstancedMaps::iterator i = m_InstancedMaps.begin(); i != m_InstancedMaps.end(); ++i)
-        i->second->DelayedUpdate(diff);
+        i->second->DelayedUpdateTransports(diff);
+}
 
+void MapInstanced::DelayedUpdate(const uint32 diff)
+{
+    // own grids first, instances only drop their references to them
     Map::DelayedUpdate(diff); // this may be removed
+
+    for (InstancedMaps::iterator i = m_InstancedMaps.begin(); i != m_InstancedMaps.end(); ++i)
+    {
+        if (sMapMgr->GetMapUpdater()->activated())
+            sMapMgr->GetMapUpdater()->schedule_delayed_update(*i->second, diff);
+        else
+            i->second->DelayedUpdate(diff);
+    }
 }
 
 /*
@@ -219,8 +231,17 @@ InstanceMap* MapInstanced::CreateInstance(uint32 InstanceId, InstanceSave* save,
     InstanceMap* map = new InstanceMap(GetId(), GetGridExpiry(), InstanceId, difficulty, this);
     ASSERT(map->IsDungeon());
 
-    map->LoadRespawnTimes();
-    map->LoadCorpseData();
+    // a new instance id has nothing worth loading, only drop what a previous owner of the id may have left
+    if (save)
+    {
+        map->LoadRespawnTimes();
+        map->LoadCorpseData();
+    }
+    else
+    {
+        map->DeleteRespawnTimes();
+        map->DeleteCorpseData();
+    }
 
     bool load_data = save != NULL;
     map->CreateInstanceData(load_data);
@@ -36,6 +36,7 @@ class MapInstanced : public Map
 
         // functions overwrite Map versions
         void Update(const uint32) override;
+        void DelayedUpdateTransports(const uint32 diff) override;
         void DelayedUpdate(const uint32 diff) override;
         //void RelocationNotify();
         void UnloadAll() override;
@@ -49,14 +50,17 @@ class MapInstanced : public Map
         }
         bool DestroyInstance(InstancedMaps::iterator &itr);
 
+        // instances load and unload grids from their own update threads
         void AddGridMapReference(const GridCoord &p)
         {
+            std::lock_guard<std::mutex> lock(_gridMapReferenceLock);
             ++GridMapReference[p.x_coord][p.y_coord];
             SetUnloadReferenceLock(GridCoord((MAX_NUMBER_OF_GRIDS - 1) - p.x_coord, (MAX_NUMBER_OF_GRIDS - 1) - p.y_coord), true);
         }
 
         void RemoveGridMapReference(GridCoord const& p)
         {
+            std::lock_guard<std::mutex> lock(_gridMapReferenceLock);
             --GridMapReference[p.x_coord][p.y_coord];
             if (!GridMapReference[p.x_coord][p.y_coord])
                 SetUnloadReferenceLock(GridCoord((MAX_NUMBER_OF_GRIDS - 1) - p.x_coord, (MAX_NUMBER_OF_GRIDS - 1) - p.y_coord), false);
@@ -66,12 +70,16 @@ class MapInstanced : public Map
         virtual void InitVisibilityDistance() override;
 
     private:
+        // instances are scheduled from here, so the parent map is never throttled
+        uint32 CalculateUpdateInterval() const override { return 0; }
+
         InstanceMap* CreateInstance(uint32 InstanceId, InstanceSave* save, Difficulty difficulty);
         BattlegroundMap* CreateBattleground(uint32 InstanceId, Battleground* bg);
         GarrisonMap* CreateGarrison(uint32 instanceId, Player* owner);
 
         InstancedMaps m_InstancedMaps;
 
+        std::mutex _gridMapReferenceLock;
         uint16 GridMapReference[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
 };
 #endif
@@ -23,6 +23,7 @@
 #include "ObjectAccessor.h"
 #include "Transport.h"
 #include "GridDefines.h"
+#include "GridMapLoader.h"
 #include "MapInstanced.h"
 #include "InstanceScript.h"
 #include "Config.h"
@@ -54,6 +55,8 @@ void MapManager::Initialize()
     // Start mtmaps if needed.
     if (num_threads > 0)
         m_updater.activate(num_threads);
+
+    sGridMapLoader->Initialize(sWorld->getIntConfig(CONFIG_GRID_PREFETCH_THREADS));
 }
 
 void MapManager::InitializeVisibilityDistanceInfo()
@@ -247,7 +250,20 @@ void MapManager::Update(uint32 diff)
         m_updater.wait();
 
     for (iter = i_maps.begin(); iter != i_maps.end(); ++iter)
-        iter->second->DelayedUpdate(uint32(i_timer.GetCurrent()));
+        iter->second->DelayedUpdateTransports(uint32(i_timer.GetCurrent()));
+
+    for (iter = i_maps.begin(); iter != i_maps.end(); ++iter)
+    {
+        if (m_updater.activated())
+            m_updater.schedule_delayed_update(*iter->second, uint32(i_timer.GetCurrent()));
+        else
+            iter->second->DelayedUpdate(uint32(i_timer.GetCurrent()));
+    }
+
+    if (m_updater.activated())
+        m_updater.wait();
+
+    sGridMapLoader->Update();
 
     i_timer.SetCurrent(0);
 }
@@ -288,6 +304,9 @@ void MapManager::UnloadAll()
     if (m_updater.activated())
         m_updater.deactivate();
 
+    sGridMapLoader->Unload();
+    InstanceMap::ClearPool();
+
     Map::DeleteStateMachine();
 }
 
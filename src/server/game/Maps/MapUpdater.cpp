@@ -19,70 +19,157 @@
 #include "MapUpdater.h"
 #include "Map.h"
 
-#include <mutex>
+#include <algorithm>
+#include <chrono>
 
-
-class MapUpdateRequest
+namespace
 {
-    private:
-
-        Map& m_map;
-        MapUpdater& m_updater;
-        uint32 m_diff;
-
-    public:
-
-        MapUpdateRequest(Map& m, MapUpdater& u, uint32 d)
-            : m_map(m), m_updater(u), m_diff(d)
-        {
-        }
-
-        void call()
-        {
-            m_map.Update (m_diff);
-            m_updater.update_finished();
-        }
-};
+    // set once by WorkerThread, the pool that owns the calling thread and its slot in that pool
+    thread_local MapUpdater const* CurrentUpdater = nullptr;
+    thread_local int32 CurrentWorkerIndex = -1;
+}
 
 void MapUpdater::activate(size_t num_threads)
 {
+    for (size_t i = 0; i < num_threads; ++i)
+        _workerQueues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+
     for (size_t i = 0; i < num_threads; ++i)
     {
-        _workerThreads.push_back(std::thread(&MapUpdater::WorkerThread, this));
+        _workerThreads.push_back(std::thread(&MapUpdater::WorkerThread, this, i));
     }
 }
 
 void MapUpdater::deactivate()
 {
-    _cancelationToken = true;
-
     wait();
 
-    _queue.Cancel();
+    _cancelationToken = true;
+
+    NotifyWorkers();
 
     for (auto& thread : _workerThreads)
     {
         thread.join();
     }
+
+    _workerThreads.clear();
+    _workerQueues.clear();
 }
 
 void MapUpdater::wait()
 {
+    DispatchBatch();
+
     std::unique_lock<std::mutex> lock(_lock);
 
-    while (pending_requests > 0)
-        _condition.wait(lock);
+    while (_pendingRequests > 0)
+        _finishedCondition.wait(lock);
 
     lock.unlock();
 }
 
 void MapUpdater::schedule_update(Map& map, uint32 diff)
 {
-    std::lock_guard<std::mutex> lock(_lock);
+    Schedule(MapUpdateRequest(&map, diff, map.GetUpdateCost(), false));
+}
+
+void MapUpdater::schedule_delayed_update(Map& map, uint32 diff)
+{
+    Schedule(MapUpdateRequest(&map, diff, 0, true));
+}
+
+void MapUpdater::Schedule(MapUpdateRequest const& request)
+{
+    ++_pendingRequests;
+
+    // instances scheduled from inside a map update stay with the worker that scheduled them, idle workers steal them from there
+    int32 workerIndex = GetCurrentWorkerIndex();
+    if (workerIndex >= 0)
+    {
+        WorkerQueue& queue = *_workerQueues[workerIndex];
+        {
+            std::lock_guard<std::mutex> lock(queue.Lock);
+            queue.Requests.push_back(request);
+            queue.Sorted = false;
+            ++_queuedRequests;
+        }
 
-    ++pending_requests;
+        NotifyWorkers();
+        return;
+    }
 
-    _queue.Push(new MapUpdateRequest(map, *this, diff));
+    std::lock_guard<std::mutex> lock(_batchLock);
+    _batch.push_back(request);
+}
+
+void MapUpdater::run_parallel(std::vector<std::function<void()>> const& tasks)
+{
+    if (!activated() || tasks.size() < 2)
+    {
+        for (std::function<void()> const& task : tasks)
+            task();
+
+        return;
+    }
+
+    TaskGroup ownGroup(tasks);
+    {
+        std::lock_guard<std::mutex> lock(_taskGroupLock);
+        _taskGroups.push_back(&ownGroup);
+        ++_openTaskGroups;
+    }
+
+    NotifyWorkers();
+
+    // help with our own tasks, then wait for the ones claimed by workers
+    TaskGroup* group = nullptr;
+    size_t taskIndex = 0;
+    while (ClaimTask(group, taskIndex, &ownGroup))
+        RunTask(*group, taskIndex);
+
+    std::unique_lock<std::mutex> lock(_taskGroupLock);
+
+    while (ownGroup.FinishedTasks < tasks.size())
+        _taskFinishedCondition.wait(lock);
+}
+
+bool MapUpdater::ClaimTask(TaskGroup*& group, size_t& taskIndex, TaskGroup* ownGroup /*= nullptr*/)
+{
+    std::lock_guard<std::mutex> lock(_taskGroupLock);
+
+    std::vector<TaskGroup*>::iterator itr = _taskGroups.begin();
+    if (ownGroup)
+        itr = std::find(_taskGroups.begin(), _taskGroups.end(), ownGroup);
+
+    if (itr == _taskGroups.end())
+        return false;
+
+    group = *itr;
+    taskIndex = group->NextTask++;
+
+    // last task claimed, nobody has to look at this group anymore
+    if (group->NextTask == group->Tasks.size())
+    {
+        _taskGroups.erase(itr);
+        --_openTaskGroups;
+    }
+
+    return true;
+}
+
+void MapUpdater::RunTask(TaskGroup& group, size_t taskIndex)
+{
+    size_t taskCount = group.Tasks.size();
+    group.Tasks[taskIndex]();
+
+    // the group lives on the stack of run_parallel and may be gone once the last task is counted
+    if (++group.FinishedTasks < taskCount)
+        return;
+
+    std::lock_guard<std::mutex> lock(_taskGroupLock);
+
+    _taskFinishedCondition.notify_all();
 }
 
 bool MapUpdater::activated()
@@ -90,28 +177,148 @@ bool MapUpdater::activated()
     return _workerThreads.size() > 0;
 }
 
-void MapUpdater::update_finished()
+int32 MapUpdater::GetCurrentWorkerIndex() const
 {
-    std::lock_guard<std::mutex> lock(_lock);
+    return CurrentUpdater == this ? CurrentWorkerIndex : -1;
+}
+
+void MapUpdater::DispatchBatch()
+{
+    std::vector<MapUpdateRequest> batch;
+    {
+        std::lock_guard<std::mutex> lock(_batchLock);
+        batch.swap(_batch);
+    }
 
-    --pending_requests;
+    if (batch.empty())
+        return;
+
+    // longest processing time first: hand the most expensive remaining map to the least loaded worker
+    std::stable_sort(batch.begin(), batch.end());
+
+    std::vector<uint64> workerLoad(_workerQueues.size(), 0);
+    for (MapUpdateRequest const& request : batch)
+    {
+        size_t workerIndex = std::min_element(workerLoad.begin(), workerLoad.end()) - workerLoad.begin();
+        workerLoad[workerIndex] += std::max<uint32>(request.Cost, 1);
+
+        WorkerQueue& queue = *_workerQueues[workerIndex];
+        std::lock_guard<std::mutex> lock(queue.Lock);
+        queue.Requests.push_back(request);
+        ++_queuedRequests;
+    }
+
+    NotifyWorkers();
+}
+
+void MapUpdater::NotifyWorkers()
+{
+    std::lock_guard<std::mutex> lock(_lock);
 
     _condition.notify_all();
 }
 
-void MapUpdater::WorkerThread()
+bool MapUpdater::PopRequest(size_t workerIndex, MapUpdateRequest& request)
 {
+    // own queue first, most expensive request at the front
+    {
+        WorkerQueue& queue = *_workerQueues[workerIndex];
+        std::lock_guard<std::mutex> lock(queue.Lock);
+        if (!queue.Requests.empty())
+        {
+            if (!queue.Sorted)
+            {
+                std::stable_sort(queue.Requests.begin(), queue.Requests.end());
+                queue.Sorted = true;
+            }
+
+            request = queue.Requests.front();
+            queue.Requests.pop_front();
+            --_queuedRequests;
+            return true;
+        }
+    }
+
+    // steal the cheapest request of another worker, its owner keeps working on the expensive ones
+    for (size_t i = 1; i < _workerQueues.size(); ++i)
+    {
+        WorkerQueue& queue = *_workerQueues[(workerIndex + i) % _workerQueues.size()];
+        std::lock_guard<std::mutex> lock(queue.Lock);
+        if (queue.Requests.empty())
+            continue;
+
+        if (!queue.Sorted)
+        {
+            std::stable_sort(queue.Requests.begin(), queue.Requests.end());
+            queue.Sorted = true;
+        }
+
+        request = queue.Requests.back();
+        queue.Requests.pop_back();
+        --_queuedRequests;
+        return true;
+    }
+
+    return false;
+}
+
+void MapUpdater::ProcessRequest(MapUpdateRequest const& request)
+{
+    if (request.Delayed)
+    {
+        request.UpdatedMap->DelayedUpdate(request.Diff);
+        update_finished();
+        return;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    request.UpdatedMap->Update(request.Diff);
+
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+    request.UpdatedMap->RecordUpdateCost(uint32(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+
+    update_finished();
+}
+
+void MapUpdater::update_finished()
+{
+    if (--_pendingRequests > 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(_lock);
+
+    _finishedCondition.notify_all();
+}
+
+void MapUpdater::WorkerThread(size_t workerIndex)
+{
+    CurrentUpdater = this;
+    CurrentWorkerIndex = int32(workerIndex);
+
     while (1)
     {
-        MapUpdateRequest* request = nullptr;
+        MapUpdateRequest request;
+        if (PopRequest(workerIndex, request))
+        {
+            ProcessRequest(request);
+            continue;
+        }
 
-        _queue.WaitAndPop(request);
+        TaskGroup* group = nullptr;
+        size_t taskIndex = 0;
+        if (ClaimTask(group, taskIndex))
+        {
+            RunTask(*group, taskIndex);
+            continue;
+        }
 
-        if (_cancelationToken)
-            return;
+        std::unique_lock<std::mutex> lock(_lock);
 
-        request->call();
+        while (_queuedRequests == 0 && _openTaskGroups == 0 && !_cancelationToken)
+            _condition.wait(lock);
 
-        delete request;
+        if (_cancelationToken && _queuedRequests == 0 && _openTaskGroups == 0)
+            return;
     }
 }
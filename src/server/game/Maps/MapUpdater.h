@@ -20,25 +20,45 @@
 #define _MAP_UPDATER_H_INCLUDED
 
 #include "Define.h"
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 #include <condition_variable>
-#include "ProducerConsumerQueue.h"
 
-class MapUpdateRequest;
 class Map;
 
+/*
+ * Updates maps on a pool of worker threads.
+ *
+ * Every worker owns a deque of requests ordered by the recent update cost
+ * of their map (most expensive first). Requests scheduled from outside the
+ * pool are collected and dispatched by wait() in longest-processing-time
+ * order, requests scheduled by a worker (instances of a MapInstanced) go
+ * to that worker's own deque. Idle workers steal the cheapest request of
+ * another worker, so the tick length follows the slowest map.
+ *
+ * run_parallel() lets a map split its own update into independent tasks,
+ * the calling thread takes part in running them so it can be used from
+ * inside a map update without starving the pool.
+ */
 class MapUpdater
 {
     public:
 
-        MapUpdater() : _cancelationToken(false), pending_requests(0) {}
+        MapUpdater() : _cancelationToken(false), _openTaskGroups(0), _pendingRequests(0), _queuedRequests(0) { }
         ~MapUpdater() { };
 
-        friend class MapUpdateRequest;
-
         void schedule_update(Map& map, uint32 diff);
 
+        void schedule_delayed_update(Map& map, uint32 diff);
+
+        // runs all tasks on the pool (serially if it is not activated) and returns once every task finished
+        void run_parallel(std::vector<std::function<void()>> const& tasks);
+
         void wait();
 
         void activate(size_t num_threads);
@@ -49,18 +69,68 @@ class MapUpdater
 
     private:
 
-        ProducerConsumerQueue<MapUpdateRequest*> _queue;
+        struct MapUpdateRequest
+        {
+            MapUpdateRequest() : UpdatedMap(nullptr), Diff(0), Cost(0), Delayed(false) { }
+            MapUpdateRequest(Map* map, uint32 diff, uint32 cost, bool delayed) : UpdatedMap(map), Diff(diff), Cost(cost), Delayed(delayed) { }
+
+            Map* UpdatedMap;
+            uint32 Diff;
+            uint32 Cost;                                        // cost estimate at schedule time, in microseconds
+            bool Delayed;                                       // Map::DelayedUpdate instead of Map::Update
+
+            bool operator<(MapUpdateRequest const& right) const { return Cost > right.Cost; }
+        };
+
+        struct WorkerQueue
+        {
+            WorkerQueue() : Sorted(true) { }
+
+            std::mutex Lock;
+            std::deque<MapUpdateRequest> Requests;              // most expensive first
+            bool Sorted;                                        // false after pushes from the owning worker
+        };
+
+        struct TaskGroup
+        {
+            TaskGroup(std::vector<std::function<void()>> const& tasks) : Tasks(tasks), NextTask(0), FinishedTasks(0) { }
+
+            std::vector<std::function<void()>> const& Tasks;
+            size_t NextTask;                                    // guarded by _taskGroupLock
+            std::atomic<size_t> FinishedTasks;
+        };
 
         std::vector<std::thread> _workerThreads;
+        std::vector<std::unique_ptr<WorkerQueue>> _workerQueues;
         std::atomic<bool> _cancelationToken;
 
-        std::mutex _lock;
-        std::condition_variable _condition;
-        size_t pending_requests;
+        // requests scheduled from outside the pool, dispatched by wait()
+        std::mutex _batchLock;
+        std::vector<MapUpdateRequest> _batch;
 
+        // task groups with unclaimed tasks
+        std::mutex _taskGroupLock;
+        std::vector<TaskGroup*> _taskGroups;
+        std::atomic<size_t> _openTaskGroups;
+        std::condition_variable _taskFinishedCondition;         // signaled when the last task of a group finishes
+
+        std::mutex _lock;
+        std::condition_variable _condition;                     // signaled when requests are queued
+        std::condition_variable _finishedCondition;             // signaled when the last pending request finishes
+        std::atomic<size_t> _pendingRequests;
+        std::atomic<size_t> _queuedRequests;
+
+        void Schedule(MapUpdateRequest const& request);
+        int32 GetCurrentWorkerIndex() const;
+        void DispatchBatch();
+        void NotifyWorkers();
+        bool PopRequest(size_t workerIndex, MapUpdateRequest& request);
+        void ProcessRequest(MapUpdateRequest const& request);
+        bool ClaimTask(TaskGroup*& group, size_t& taskIndex, TaskGroup* ownGroup = nullptr);
+        void RunTask(TaskGroup& group, size_t taskIndex);
         void update_finished();
 
-        void WorkerThread();
+        void WorkerThread(size_t workerIndex);
 };
 
 #endif //_MAP_UPDATER_H_INCLUDED
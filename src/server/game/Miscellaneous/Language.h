@@ -990,7 +990,10 @@ enum TrinityStrings
     LANG_ACCOUNT_BNET_UNLINKED          = 1188,
     LANG_ACCOUNT_BNET_NOT_LINKED        = 1189,
     LANG_DISALLOW_TICKETS_CONFIG        = 1190,
-    // Room for more level 3              1191-1198 not used
+    LANG_LIST_RESPAWNS_HEADER           = 1191,
+    LANG_LIST_RESPAWNS_ENTRY            = 1192,
+    LANG_LIST_RESPAWNS_ENTRY_DUE        = 1193,
+    // Room for more level 3              1194-1198 not used
 
     // Debug commands
     LANG_DEBUG_AREATRIGGER_LEFT         = 1999,
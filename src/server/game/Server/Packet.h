@@ -70,6 +70,7 @@ namespace WorldPackets
         }
 
         OpcodeClient GetOpcode() const { return OpcodeClient(_worldPacket.GetOpcode()); }
+        WorldPacket&& Move() { return std::move(_worldPacket); }
     };
 }
 
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OpcodeStats.h"
+#include "Log.h"
+#include "Util.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+void OpcodeStats::RecordHandled(uint32 opcode, uint32 size, uint64 microseconds)
+{
+    if (opcode >= NUM_OPCODE_HANDLERS)
+        return;
+
+    HandlerCounters& counters = _handlers[opcode];
+    counters.Count.fetch_add(1, std::memory_order_relaxed);
+    counters.Bytes.fetch_add(size, std::memory_order_relaxed);
+    counters.TotalTime.fetch_add(microseconds, std::memory_order_relaxed);
+
+    uint32 time = uint32(std::min<uint64>(microseconds, 0xFFFFFFFF));
+    uint32 maxTime = counters.MaxTime.load(std::memory_order_relaxed);
+    while (time > maxTime && !counters.MaxTime.compare_exchange_weak(maxTime, time, std::memory_order_relaxed))
+        ;
+
+    uint32 bucket = 0;
+    while (microseconds > 1 && bucket < OPCODE_STATS_LATENCY_BUCKETS - 1)
+    {
+        microseconds >>= 1;
+        ++bucket;
+    }
+
+    counters.Buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void OpcodeStats::RecordSent(uint32 opcode, uint32 size)
+{
+    if (opcode >= NUM_OPCODE_HANDLERS)
+        return;
+
+    _sent[opcode].Count.fetch_add(1, std::memory_order_relaxed);
+    _sent[opcode].Bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+std::vector<OpcodeStats::HandlerSummary> OpcodeStats::GetHandlerSummaries() const
+{
+    std::vector<HandlerSummary> summaries;
+    for (uint32 opcode = 0; opcode < NUM_OPCODE_HANDLERS; ++opcode)
+    {
+        HandlerCounters const& counters = _handlers[opcode];
+        uint64 count = counters.Count.load(std::memory_order_relaxed);
+        if (!count)
+            continue;
+
+        ClientOpcodeHandler const* handler = opcodeTable[OpcodeClient(opcode)];
+
+        HandlerSummary summary;
+        summary.Opcode = OpcodeClient(opcode);
+        summary.Processing = handler ? handler->ProcessingPlace : PROCESS_INPLACE;
+        summary.Count = count;
+        summary.Bytes = counters.Bytes.load(std::memory_order_relaxed);
+        summary.TotalTime = counters.TotalTime.load(std::memory_order_relaxed);
+        summary.MaxTime = counters.MaxTime.load(std::memory_order_relaxed);
+        summary.P50 = 0;
+        summary.P99 = 0;
+
+        uint64 buckets[OPCODE_STATS_LATENCY_BUCKETS];
+        uint64 total = 0;
+        for (uint32 i = 0; i < OPCODE_STATS_LATENCY_BUCKETS; ++i)
+        {
+            buckets[i] = counters.Buckets[i].load(std::memory_order_relaxed);
+            total += buckets[i];
+        }
+
+        uint64 seen = 0;
+        for (uint32 i = 0; i < OPCODE_STATS_LATENCY_BUCKETS; ++i)
+        {
+            seen += buckets[i];
+            if (!summary.P50 && seen * 2 >= total)
+                summary.P50 = UI64LIT(1) << (i + 1);
+            if (!summary.P99 && seen * 100 >= total * 99)
+                summary.P99 = UI64LIT(1) << (i + 1);
+        }
+
+        summaries.push_back(summary);
+    }
+
+    std::sort(summaries.begin(), summaries.end(), [](HandlerSummary const& left, HandlerSummary const& right)
+    {
+        return left.TotalTime > right.TotalTime;
+    });
+
+    return summaries;
+}
+
+std::vector<OpcodeStats::SentSummary> OpcodeStats::GetSentSummaries() const
+{
+    std::vector<SentSummary> summaries;
+    for (uint32 opcode = 0; opcode < NUM_OPCODE_HANDLERS; ++opcode)
+    {
+        uint64 count = _sent[opcode].Count.load(std::memory_order_relaxed);
+        if (!count)
+            continue;
+
+        SentSummary summary;
+        summary.Opcode = OpcodeServer(opcode);
+        summary.Count = count;
+        summary.Bytes = _sent[opcode].Bytes.load(std::memory_order_relaxed);
+        summaries.push_back(summary);
+    }
+
+    std::sort(summaries.begin(), summaries.end(), [](SentSummary const& left, SentSummary const& right)
+    {
+        return left.Bytes > right.Bytes;
+    });
+
+    return summaries;
+}
+
+void OpcodeStats::SumByProcessing(std::vector<HandlerSummary> const& handlers, ProcessingSummary (&totals)[PROCESS_THREADSAFE + 1])
+{
+    memset(totals, 0, sizeof(totals));
+    for (HandlerSummary const& summary : handlers)
+    {
+        totals[summary.Processing].Count += summary.Count;
+        totals[summary.Processing].Bytes += summary.Bytes;
+        totals[summary.Processing].TotalTime += summary.TotalTime;
+    }
+}
+
+char const* OpcodeStats::GetProcessingName(PacketProcessing processing)
+{
+    switch (processing)
+    {
+        case PROCESS_INPLACE:
+            return "INPLACE";
+        case PROCESS_THREADUNSAFE:
+            return "THREADUNSAFE";
+        case PROCESS_THREADSAFE:
+            return "THREADSAFE";
+        default:
+            return "UNKNOWN";
+    }
+}
+
+void OpcodeStats::Reset()
+{
+    // runs while sessions keep recording, a handler finishing meanwhile may be half counted
+    for (uint32 opcode = 0; opcode < NUM_OPCODE_HANDLERS; ++opcode)
+    {
+        HandlerCounters& counters = _handlers[opcode];
+        counters.Count.store(0, std::memory_order_relaxed);
+        counters.Bytes.store(0, std::memory_order_relaxed);
+        counters.TotalTime.store(0, std::memory_order_relaxed);
+        counters.MaxTime.store(0, std::memory_order_relaxed);
+        for (uint32 i = 0; i < OPCODE_STATS_LATENCY_BUCKETS; ++i)
+            counters.Buckets[i].store(0, std::memory_order_relaxed);
+
+        _sent[opcode].Count.store(0, std::memory_order_relaxed);
+        _sent[opcode].Bytes.store(0, std::memory_order_relaxed);
+    }
+
+    _resetTime = time(NULL);
+}
+
+void OpcodeStats::Dump(std::string const& fileName)
+{
+    std::string path = sLog->GetLogsDir() + fileName;
+    FILE* file = fopen(path.c_str(), "a");
+    if (!file)
+    {
+        TC_LOG_ERROR("network", "OpcodeStats::Dump: can't open %s for writing", path.c_str());
+        return;
+    }
+
+    time_t now = time(NULL);
+    fprintf(file, "==== %s, %u seconds ====\n", TimeToTimestampStr(now).c_str(), uint32(now - _resetTime));
+
+    std::vector<HandlerSummary> handlers = GetHandlerSummaries();
+
+    ProcessingSummary totals[PROCESS_THREADSAFE + 1];
+    SumByProcessing(handlers, totals);
+    for (uint8 i = PROCESS_INPLACE; i <= PROCESS_THREADSAFE; ++i)
+        fprintf(file, "%-12s count " UI64FMTD " bytes in " UI64FMTD " handler time " UI64FMTD " us\n",
+            GetProcessingName(PacketProcessing(i)), totals[i].Count, totals[i].Bytes, totals[i].TotalTime);
+
+    fprintf(file, "%-50s %-12s %10s %12s %14s %8s %8s %10s\n", "Handler", "Processing", "Count", "Bytes in", "Total us", "p50 <", "p99 <", "Max us");
+    for (HandlerSummary const& summary : handlers)
+        fprintf(file, "%-50s %-12s %10" PRIu64 " %12" PRIu64 " %14" PRIu64 " %8" PRIu64 " %8" PRIu64 " %10u\n",
+            opcodeTable[summary.Opcode] ? opcodeTable[summary.Opcode]->Name : "UNKNOWN OPCODE", GetProcessingName(summary.Processing),
+            summary.Count, summary.Bytes, summary.TotalTime, summary.P50, summary.P99, summary.MaxTime);
+
+    fprintf(file, "%-50s %10s %12s\n", "Sent", "Count", "Bytes out");
+    for (SentSummary const& summary : GetSentSummaries())
+        fprintf(file, "%-50s %10" PRIu64 " %12" PRIu64 "\n",
+            opcodeTable[summary.Opcode] ? opcodeTable[summary.Opcode]->Name : "UNKNOWN OPCODE", summary.Count, summary.Bytes);
+
+    fprintf(file, "\n");
+    fclose(file);
+
+    Reset();
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OpcodeStats_h__
+#define OpcodeStats_h__
+
+#include "Opcodes.h"
+#include <atomic>
+#include <string>
+#include <vector>
+
+// bucket i counts handler runs that took [2^i, 2^(i+1)) microseconds, the last one everything above
+#define OPCODE_STATS_LATENCY_BUCKETS 20
+
+/// Handler latency and traffic per opcode, recorded by every thread updating sessions with relaxed atomics
+class OpcodeStats
+{
+    OpcodeStats() { Reset(); }
+
+public:
+    struct HandlerSummary
+    {
+        OpcodeClient Opcode;
+        PacketProcessing Processing;
+        uint64 Count;
+        uint64 Bytes;
+        uint64 TotalTime;                                   // microseconds
+        uint64 P50;                                         // upper bound of the bucket holding the percentile
+        uint64 P99;
+        uint32 MaxTime;
+    };
+
+    struct ProcessingSummary
+    {
+        uint64 Count;
+        uint64 Bytes;
+        uint64 TotalTime;
+    };
+
+    struct SentSummary
+    {
+        OpcodeServer Opcode;
+        uint64 Count;
+        uint64 Bytes;
+    };
+
+    static OpcodeStats& Instance()
+    {
+        static OpcodeStats instance;
+        return instance;
+    }
+
+    /// A client packet went through WorldSession::Update, size is its payload
+    void RecordHandled(uint32 opcode, uint32 size, uint64 microseconds);
+    /// A packet was queued for a client, broadcasts count once per receiver
+    void RecordSent(uint32 opcode, uint32 size);
+
+    /// Opcodes handled since the last reset, most total time first
+    std::vector<HandlerSummary> GetHandlerSummaries() const;
+    /// Opcodes sent since the last reset, most bytes first
+    std::vector<SentSummary> GetSentSummaries() const;
+    time_t GetResetTime() const { return _resetTime; }
+
+    /// Totals of the handler summaries per PacketProcessing
+    static void SumByProcessing(std::vector<HandlerSummary> const& handlers, ProcessingSummary (&totals)[PROCESS_THREADSAFE + 1]);
+    static char const* GetProcessingName(PacketProcessing processing);
+
+    void Reset();
+    /// Appends a report of everything since the last reset to the file, then resets
+    void Dump(std::string const& fileName);
+
+private:
+    struct HandlerCounters
+    {
+        std::atomic<uint64> Count;
+        std::atomic<uint64> Bytes;
+        std::atomic<uint64> TotalTime;
+        std::atomic<uint32> MaxTime;
+        std::atomic<uint32> Buckets[OPCODE_STATS_LATENCY_BUCKETS];
+    };
+
+    struct SentCounters
+    {
+        std::atomic<uint64> Count;
+        std::atomic<uint64> Bytes;
+    };
+
+    HandlerCounters _handlers[NUM_OPCODE_HANDLERS];
+    SentCounters _sent[NUM_OPCODE_HANDLERS];
+    std::atomic<time_t> _resetTime;
+};
+
+#define sOpcodeStats OpcodeStats::Instance()
+
+#endif // OpcodeStats_h__
@@ -31,6 +31,9 @@ public:
         PacketClass nicePacket(std::move(packet));
         nicePacket.Read();
         (session->*HandlerFunction)(nicePacket);
+
+        // hand the storage back, the session recycles it for the socket's next reads
+        packet = nicePacket.Move();
     }
 };
 
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SharedPacket.h"
+#include "Log.h"
+#include "WorldSocket.h"
+
+#include <zlib.h>
+
+std::vector<uint8> const& SharedPacket::GetCompressed() const
+{
+    std::call_once(_compressOnce, &SharedPacket::Compress, this);
+    return _compressed;
+}
+
+void SharedPacket::Compress() const
+{
+    uint32 opcode = _packet.GetOpcode();
+    _uncompressedAdler = adler32(adler32(0x9827D8F1, (Bytef*)&opcode, 4), _packet.contents(), _packet.size());
+
+    // a stream of its own, no history from any connection, so the output can be spliced into all of them
+    z_stream stream;
+    stream.zalloc = (alloc_func)NULL;
+    stream.zfree = (free_func)NULL;
+    stream.opaque = (voidpf)NULL;
+    stream.avail_in = 0;
+    stream.next_in = NULL;
+
+    int32 z_res = deflateInit2(&stream, WorldSocket::GetCompressionLevel(_packet), Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    if (z_res != Z_OK)
+    {
+        TC_LOG_ERROR("network", "Can't initialize shared packet compression (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
+        return;
+    }
+
+    // sync flush appends an empty stored block, leave room for it on top of the bound
+    _compressed.resize(deflateBound(&stream, _packet.size() + sizeof(opcode)) + 8);
+
+    stream.next_out = _compressed.data();
+    stream.avail_out = _compressed.size();
+
+    stream.next_in = (Bytef*)&opcode;
+    stream.avail_in = sizeof(uint32);
+
+    z_res = deflate(&stream, Z_NO_FLUSH);
+    if (z_res == Z_OK)
+    {
+        stream.next_in = (Bytef*)_packet.contents();
+        stream.avail_in = _packet.size();
+
+        // never Z_FINISH, the client keeps inflating the connection stream after this packet
+        z_res = deflate(&stream, Z_SYNC_FLUSH);
+    }
+
+    if (z_res != Z_OK)
+    {
+        TC_LOG_ERROR("network", "Can't compress shared packet (zlib: deflate) Error code: %i (%s, msg: %s)", z_res, zError(z_res), stream.msg);
+        _compressed.clear();
+    }
+    else
+    {
+        _compressed.resize(_compressed.size() - stream.avail_out);
+        _compressedAdler = adler32(0x9827D8F1, _compressed.data(), _compressed.size());
+    }
+
+    deflateEnd(&stream);
+}
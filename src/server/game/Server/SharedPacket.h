@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SharedPacket_h__
+#define SharedPacket_h__
+
+#include "WorldPacket.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// Immutable packet handed to many sessions, each socket queues a reference instead of its own copy.
+/// Broadcasts large enough to be compressed are deflated once, on their own, by the first socket writing them.
+class SharedPacket
+{
+public:
+    explicit SharedPacket(WorldPacket const& packet, bool broadcast = true) : _packet(packet), _broadcast(broadcast),
+        _uncompressedAdler(0), _compressedAdler(0) { }
+    explicit SharedPacket(WorldPacket&& packet, bool broadcast = true) : _packet(std::move(packet)), _broadcast(broadcast),
+        _uncompressedAdler(0), _compressedAdler(0) { }
+
+    SharedPacket(SharedPacket const& right) = delete;
+    SharedPacket& operator=(SharedPacket const& right) = delete;
+
+    WorldPacket const& GetPacket() const { return _packet; }
+
+    /// Unicast packets are compressed with the per connection stream, broadcasts with GetCompressed
+    bool IsBroadcast() const { return _broadcast; }
+
+    /// Opcode and payload as raw deflate blocks ending in a sync flush, empty if compressing failed
+    std::vector<uint8> const& GetCompressed() const;
+    uint32 GetUncompressedAdler() const { GetCompressed(); return _uncompressedAdler; }
+    uint32 GetCompressedAdler() const { GetCompressed(); return _compressedAdler; }
+
+private:
+    void Compress() const;
+
+    WorldPacket const _packet;
+    bool const _broadcast;
+
+    mutable std::once_flag _compressOnce;
+    mutable std::vector<uint8> _compressed;
+    mutable uint32 _uncompressedAdler;
+    mutable uint32 _compressedAdler;
+};
+
+typedef std::shared_ptr<SharedPacket const> SharedPacketPtr;
+
+#endif // SharedPacket_h__
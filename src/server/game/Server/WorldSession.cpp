@@ -27,6 +27,7 @@
 #include "AccountMgr.h"
 #include "Log.h"
 #include "Opcodes.h"
+#include "OpcodeStats.h"
 #include "WorldPacket.h"
 #include "WorldSession.h"
 #include "Player.h"
@@ -58,6 +59,22 @@ namespace {
 
 std::string const DefaultPlayerName = "<none>";
 
+// sent by idle clients as well, they do not tell anything about the player's activity
+bool IsKeepAliveOpcode(uint32 opcode)
+{
+    switch (opcode)
+    {
+        case CMSG_KEEP_ALIVE:
+        case CMSG_TIME_SYNC_RESPONSE:
+        case CMSG_TIME_SYNC_RESPONSE_FAILED:
+        case CMSG_QUERY_TIME:
+        case CMSG_LOG_DISCONNECT:
+            return true;
+        default:
+            return false;
+    }
+}
+
 } // namespace
 
 bool MapSessionFilter::Process(WorldPacket* packet)
@@ -130,6 +147,7 @@ WorldSession::WorldSession(uint32 id, std::string&& name, uint32 battlenetAccoun
     recruiterId(recruiter),
     isRecruiter(isARecruiter),
     _RBACData(NULL),
+    _nextRecvConnection(CONNECTION_TYPE_REALM),
     expireTime(60000), // 1 min after socket loss, session is deleted
     forceExit(false),
     m_currentBankerGUID(),
@@ -170,9 +188,8 @@ WorldSession::~WorldSession()
     delete _warden;
     delete _RBACData;
 
-    ///- empty incoming packet queue
-    WorldPacket* packet = NULL;
-    while (_recvQueue.next(packet))
+    ///- empty delayed packet queue, the sockets free what they still hold
+    for (WorldPacket* packet : _delayedPackets)
         delete packet;
 
     LoginDatabase.PExecute("UPDATE account SET online = 0 WHERE id = %u;", GetAccountId());     // One-time query
@@ -206,16 +223,52 @@ std::string WorldSession::GetPlayerInfo() const
 
 /// Send a packet to the client
 void WorldSession::SendPacket(WorldPacket const* packet, bool forced /*= false*/)
+{
+    ConnectionType conIdx;
+    if (!PrepareSendPacket(packet, forced, conIdx))
+        return;
+
+    m_Socket[conIdx]->SendPacket(*packet);
+}
+
+/// Send a packet shared with other sessions, the socket keeps a reference instead of a copy
+void WorldSession::SendSharedPacket(SharedPacketPtr const& packet, bool forced /*= false*/)
+{
+    ConnectionType conIdx;
+    if (!PrepareSendPacket(&packet->GetPacket(), forced, conIdx))
+        return;
+
+    m_Socket[conIdx]->SendSharedPacket(packet);
+}
+
+/// Send several packets to the client, the packets of each connection are written to its socket together
+void WorldSession::SendPackets(std::vector<SharedPacketPtr> const& packets)
+{
+    std::vector<SharedPacketPtr> connectionPackets[MAX_CONNECTION_TYPES];
+    for (SharedPacketPtr const& packet : packets)
+    {
+        ConnectionType conIdx;
+        if (PrepareSendPacket(&packet->GetPacket(), false, conIdx))
+            connectionPackets[conIdx].push_back(packet);
+    }
+
+    for (uint8 i = 0; i < MAX_CONNECTION_TYPES; ++i)
+        if (!connectionPackets[i].empty())
+            m_Socket[i]->SendPackets(connectionPackets[i]);
+}
+
+/// Checks the packet can be sent and picks its connection
+bool WorldSession::PrepareSendPacket(WorldPacket const* packet, bool forced, ConnectionType& conIdx)
 {
     if (packet->GetOpcode() == NULL_OPCODE)
     {
         TC_LOG_ERROR("network.opcode", "Prevented sending of NULL_OPCODE to %s", GetPlayerInfo().c_str());
-        return;
+        return false;
     }
     else if (packet->GetOpcode() == UNKNOWN_OPCODE)
     {
         TC_LOG_ERROR("network.opcode", "Prevented sending of UNKNOWN_OPCODE to %s", GetPlayerInfo().c_str());
-        return;
+        return false;
     }
 
     ServerOpcodeHandler const* handler = opcodeTable[static_cast<OpcodeServer>(packet->GetOpcode())];
@@ -223,11 +276,11 @@ void WorldSession::SendPacket(WorldPacket const* packet, bool forced /*= false*/
     if (!handler)
     {
         TC_LOG_ERROR("network.opcode", "Prevented sending of opcode %u with non existing handler to %s", packet->GetOpcode(), GetPlayerInfo().c_str());
-        return;
+        return false;
     }
 
     // Default connection index defined in Opcodes.cpp table
-    ConnectionType conIdx = handler->ConnectionIndex;
+    conIdx = handler->ConnectionIndex;
 
     // Override connection index
     if (packet->GetConnection() != CONNECTION_TYPE_DEFAULT)
@@ -235,7 +288,7 @@ void WorldSession::SendPacket(WorldPacket const* packet, bool forced /*= false*/
         if (packet->GetConnection() != CONNECTION_TYPE_INSTANCE && IsInstanceOnlyOpcode(packet->GetOpcode()))
         {
             TC_LOG_ERROR("network.opcode", "Prevented sending of instance only opcode %u with connection type %u to %s", packet->GetOpcode(), packet->GetConnection(), GetPlayerInfo().c_str());
-            return;
+            return false;
         }
 
         conIdx = packet->GetConnection();
@@ -244,7 +297,7 @@ void WorldSession::SendPacket(WorldPacket const* packet, bool forced /*= false*/
     if (!m_Socket[conIdx])
     {
         TC_LOG_ERROR("network.opcode", "Prevented sending of %s to non existent socket %u to %s", GetOpcodeNameForLogging(static_cast<OpcodeServer>(packet->GetOpcode())).c_str(), conIdx, GetPlayerInfo().c_str());
-        return;
+        return false;
     }
 
     if (!forced)
@@ -252,7 +305,7 @@ void WorldSession::SendPacket(WorldPacket const* packet, bool forced /*= false*/
         if (handler->Status == STATUS_UNHANDLED)
         {
             TC_LOG_ERROR("network.opcode", "Prevented sending disabled opcode %s to %s", GetOpcodeNameForLogging(static_cast<OpcodeServer>(packet->GetOpcode())).c_str(), GetPlayerInfo().c_str());
-            return;
+            return false;
         }
     }
 
@@ -292,14 +345,50 @@ void WorldSession::SendPacket(WorldPacket const* packet, bool forced /*= false*/
 
     sScriptMgr->OnPacketSend(this, *packet);
 
+    if (sWorld->getBoolConfig(CONFIG_OPCODE_STATS))
+        sOpcodeStats.RecordSent(packet->GetOpcode(), packet->size());
+
     TC_LOG_TRACE("network.opcode", "S->C: %s %s", GetPlayerInfo().c_str(), GetOpcodeNameForLogging(static_cast<OpcodeServer>(packet->GetOpcode())).c_str());
-    m_Socket[conIdx]->SendPacket(*packet);
+    return true;
 }
 
-/// Add an incoming packet to the queue
-void WorldSession::QueuePacket(WorldPacket* new_packet)
+/// Take the next packet to handle, the delayed ones first, then the ones read by each socket in turn
+bool WorldSession::NextPacket(WorldPacket*& packet, WorldPacket const* firstDelayedPacket, PacketFilter& updater)
 {
-    _recvQueue.add(new_packet);
+    //! Reaching firstDelayedPacket means every packet delayed by earlier updates was tried once,
+    //! the rest were delayed again by this update and wait for the next one
+    if (!_delayedPackets.empty() && _delayedPackets.front() != firstDelayedPacket)
+    {
+        if (!updater.Process(_delayedPackets.front()))
+            return false;
+
+        packet = _delayedPackets.front();
+        _delayedPackets.pop_front();
+        return true;
+    }
+
+    for (uint8 i = 0; i < MAX_CONNECTION_TYPES; ++i)
+    {
+        uint8 conIdx = (_nextRecvConnection + i) % MAX_CONNECTION_TYPES;
+        if (!m_Socket[conIdx] || !m_Socket[conIdx]->PeekReceivedPacket(packet) || !updater.Process(packet))
+            continue;
+
+        m_Socket[conIdx]->PopReceivedPacket();
+        _nextRecvConnection = (conIdx + 1) % MAX_CONNECTION_TYPES;
+        return true;
+    }
+
+    return false;
+}
+
+/// Give a handled packet back to the socket it was read from, for its next reads
+void WorldSession::RecyclePacket(WorldPacket* packet)
+{
+    ConnectionType conIdx = packet->GetConnection();
+    if (uint32(conIdx) < MAX_CONNECTION_TYPES && m_Socket[conIdx])
+        m_Socket[conIdx]->RecyclePacket(packet);
+    else
+        delete packet;
 }
 
 /// Logging helper for unexpected opcodes
@@ -338,21 +427,26 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
     ///- Retrieve packets from the receive queue and call the appropriate handlers
     /// not process packets if socket already closed
     WorldPacket* packet = NULL;
-    //! Delete packet after processing by default
-    bool deletePacket = true;
+    //! Recycle packet after processing by default
+    bool recyclePacket = true;
     //! To prevent infinite loop
     WorldPacket* firstDelayedPacket = NULL;
-    //! If _recvQueue.peek() == firstDelayedPacket it means that in this Update call, we've processed all
-    //! *properly timed* packets, and we're now at the part of the queue where we find
-    //! delayed packets that were re-enqueued due to improper timing. To prevent an infinite
-    //! loop caused by re-enqueueing the same packets over and over again, we stop updating this session
-    //! and continue updating others. The re-enqueued packets will be handled in the next Update call for this session.
+    //! Packets delayed due to improper timing are put aside and retried before the newly received ones.
+    //! Once NextPacket reaches firstDelayedPacket, every packet delayed before this Update call has been retried,
+    //! so to prevent re-enqueueing the same packets over and over again, the rest wait for the next Update call.
     uint32 processedPackets = 0;
     time_t currentTime = time(NULL);
+    bool const recordStats = sWorld->getBoolConfig(CONFIG_OPCODE_STATS);
 
-    while (m_Socket[CONNECTION_TYPE_REALM] && !_recvQueue.empty() && _recvQueue.peek(true) != firstDelayedPacket && _recvQueue.next(packet, updater))
+    while (m_Socket[CONNECTION_TYPE_REALM] && NextPacket(packet, firstDelayedPacket, updater))
     {
         ClientOpcodeHandler const* opHandle = opcodeTable[static_cast<OpcodeClient>(packet->GetOpcode())];
+        //! Handlers may take the storage over, read the size first
+        uint32 packetSize = packet->size();
+        std::chrono::steady_clock::time_point handlerStart;
+        if (recordStats)
+            handlerStart = std::chrono::steady_clock::now();
+
         try
         {
             switch (opHandle->Status)
@@ -369,8 +463,8 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
                             if (!firstDelayedPacket)
                                 firstDelayedPacket = packet;
                             //! Because checking a bool is faster than reallocating memory
-                            deletePacket = false;
-                            QueuePacket(packet);
+                            recyclePacket = false;
+                            _delayedPackets.push_back(packet);
                             //! Log
                                 TC_LOG_DEBUG("network", "Re-enqueueing packet with opcode %s with with status STATUS_LOGGEDIN. "
                                     "Player is currently not in world yet.", GetOpcodeNameForLogging(static_cast<OpcodeClient>(packet->GetOpcode())).c_str());
@@ -381,6 +475,10 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
                         sScriptMgr->OnPacketReceive(this, *packet);
                         opHandle->Call(this, *packet);
                         LogUnprocessedTail(packet);
+
+                        // the first action of a player brings a throttled map back to full rate, keep alives do not count
+                        if (_player && _player->IsInWorld() && !IsKeepAliveOpcode(packet->GetOpcode()))
+                            _player->GetMap()->ResetUpdateInterval();
                     }
                     // lag can cause STATUS_LOGGEDIN opcodes to arrive after the player started a transfer
                     break;
@@ -450,10 +548,15 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
             packet->hexlike();
         }
 
-        if (deletePacket)
-            delete packet;
+        //! Delayed packets are counted once they are handled
+        if (recordStats && recyclePacket)
+            sOpcodeStats.RecordHandled(packet->GetOpcode(), packetSize,
+                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - handlerStart).count());
+
+        if (recyclePacket)
+            RecyclePacket(packet);
 
-        deletePacket = true;
+        recyclePacket = true;
 
 #define MAX_PROCESSED_PACKETS_IN_SAME_WORLDSESSION_UPDATE 100
         processedPackets++;
@@ -29,8 +29,10 @@
 #include "DatabaseEnv.h"
 #include "World.h"
 #include "Packet.h"
+#include "SharedPacket.h"
 #include "Cryptography/BigNumber.h"
 #include "AccountMgr.h"
+#include <deque>
 #include <unordered_set>
 
 class BattlePetMgr;
@@ -839,6 +841,8 @@ class WorldSession
         bool IsAddonRegistered(const std::string& prefix) const;
 
         void SendPacket(WorldPacket const* packet, bool forced = false);
+        void SendSharedPacket(SharedPacketPtr const& packet, bool forced = false);
+        void SendPackets(std::vector<SharedPacketPtr> const& packets);
         void AddInstanceConnection(std::shared_ptr<WorldSocket> sock) { m_Socket[CONNECTION_TYPE_INSTANCE] = sock; }
 
         void SendNotification(char const* format, ...) ATTR_PRINTF(2, 3);
@@ -897,7 +901,6 @@ class WorldSession
         void LogoutPlayer(bool save);
         void KickPlayer();
 
-        void QueuePacket(WorldPacket* new_packet);
         bool Update(uint32 diff, PacketFilter& updater);
 
         /// Handle the authentication waiting queue (to be completed)
@@ -1695,6 +1698,10 @@ class WorldSession
 
         bool CanUseBank(ObjectGuid bankerGUID = ObjectGuid::Empty) const;
 
+        bool PrepareSendPacket(WorldPacket const* packet, bool forced, ConnectionType& conIdx);
+        bool NextPacket(WorldPacket*& packet, WorldPacket const* firstDelayedPacket, PacketFilter& updater);
+        void RecyclePacket(WorldPacket* packet);
+
         // logging helper
         void LogUnexpectedOpcode(WorldPacket* packet, const char* status, const char *reason);
         void LogUnprocessedTail(WorldPacket* packet);
@@ -1744,7 +1751,8 @@ class WorldSession
         bool _filterAddonMessages;
         uint32 recruiterId;
         bool isRecruiter;
-        LockedQueue<WorldPacket*> _recvQueue;
+        std::deque<WorldPacket*> _delayedPackets;          // received before the player was in world
+        uint8 _nextRecvConnection;                          // socket read from first, alternates so neither starves
         rbac::RBACData* _RBACData;
         uint32 expireTime;
         bool forceExit;
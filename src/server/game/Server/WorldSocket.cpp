@@ -55,13 +55,20 @@ uint32 const SizeOfClientHeader[2][2] =
 uint32 const SizeOfServerHeader[2] = { sizeof(uint16) + sizeof(uint32), sizeof(uint32) };
 WorldSocket::WorldSocket(tcp::socket&& socket) : Socket(std::move(socket)),
     _type(CONNECTION_TYPE_REALM), _authSeed(rand32()), _OverSpeedPings(0),
-    _worldSession(nullptr), _authed(false), _compressionStream(nullptr), _initialized(false)
+    _worldSession(nullptr), _authed(false), _compressionStream(nullptr), _compressionLevel(0), _sendQueueScheduled(false), _initialized(false)
 {
     _headerBuffer.Resize(SizeOfClientHeader[0][0]);
 }
 
 WorldSocket::~WorldSocket()
 {
+    WorldPacket* packet;
+    while (_recvQueue.Pop(packet))
+        delete packet;
+
+    while (_packetPool.Pop(packet))
+        delete packet;
+
     if (_compressionStream)
     {
         deflateEnd(_compressionStream);
@@ -122,6 +129,8 @@ void WorldSocket::CheckIpCallback(PreparedQueryResult result)
 
 bool WorldSocket::Update()
 {
+    ProcessSendQueue();
+
     if (!BaseSocket::Update())
         return false;
 
@@ -367,8 +376,25 @@ WorldSocket::ReadDataHandlerResult WorldSocket::ReadDataHandler()
                 // Catches people idling on the login screen and any lingering ingame connections.
                 _worldSession->ResetTimeOutTime();
 
-                // Copy the packet to the heap before enqueuing
-                _worldSession->QueuePacket(new WorldPacket(std::move(packet)));
+                // Reuse a packet the session is done with, its storage becomes the payload buffer of the next read
+                WorldPacket* queuedPacket;
+                if (_packetPool.Pop(queuedPacket))
+                {
+                    std::vector<uint8> storage = queuedPacket->Move();
+                    if (storage.capacity() <= WORLD_SOCKET_MAX_POOLED_STORAGE)
+                        _packetBuffer.Reuse(std::move(storage));
+                }
+                else
+                    queuedPacket = new WorldPacket();
+
+                *queuedPacket = std::move(packet);
+                if (!_recvQueue.Push(queuedPacket))
+                {
+                    TC_LOG_ERROR("network", "WorldSocket::ReadDataHandler: receive queue of %s is full (%u packets), disconnecting",
+                        _worldSession->GetPlayerInfo().c_str(), uint32(WORLD_SOCKET_RECV_QUEUE_SIZE));
+                    delete queuedPacket;
+                    return ReadDataHandlerResult::Error;
+                }
                 break;
             }
         }
@@ -385,7 +411,8 @@ WorldSocket::ReadDataHandlerResult WorldSocket::ReadDataHandler()
         _compressionStream->opaque = (voidpf)NULL;
         _compressionStream->avail_in = 0;
         _compressionStream->next_in = NULL;
-        int32 z_res = deflateInit2(_compressionStream, sWorld->getIntConfig(CONFIG_COMPRESSION), Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+        _compressionLevel = sWorld->getIntConfig(CONFIG_COMPRESSION);
+        int32 z_res = deflateInit2(_compressionStream, _compressionLevel, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
         if (z_res != Z_OK)
         {
             TC_LOG_ERROR("network", "Can't initialize packet compression (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
@@ -414,6 +441,12 @@ void WorldSocket::LogOpcodeText(OpcodeClient opcode, std::unique_lock<std::mutex
     }
 }
 
+void WorldSocket::RecyclePacket(WorldPacket* packet)
+{
+    if (!_packetPool.Push(packet))
+        delete packet;
+}
+
 void WorldSocket::SendPacketAndLogOpcode(WorldPacket const& packet)
 {
     TC_LOG_TRACE("network.opcode", "S->C: %s %s", GetRemoteIpAddress().to_string().c_str(), GetOpcodeNameForLogging(static_cast<OpcodeServer>(packet.GetOpcode())).c_str());
@@ -428,27 +461,105 @@ void WorldSocket::SendPacket(WorldPacket const& packet)
     if (sPacketLog->CanLogPacket())
         sPacketLog->LogPacket(packet, SERVER_TO_CLIENT, GetRemoteIpAddress(), GetRemotePort(), GetConnectionType());
 
-    uint32 packetSize = packet.size();
-    uint32 sizeOfHeader = SizeOfServerHeader[_authCrypt.IsInitialized()];
-    if (packetSize > MinSizeForCompression && _authCrypt.IsInitialized())
-        packetSize = compressBound(packetSize) + sizeof(CompressedWorldPacket);
+    _sendQueue.add(std::make_shared<SharedPacket>(packet, false));
+    ScheduleSendQueue();
+}
+
+void WorldSocket::SendSharedPacket(SharedPacketPtr const& packet)
+{
+    if (!IsOpen())
+        return;
+
+    if (sPacketLog->CanLogPacket())
+        sPacketLog->LogPacket(packet->GetPacket(), SERVER_TO_CLIENT, GetRemoteIpAddress(), GetRemotePort(), GetConnectionType());
+
+    _sendQueue.add(packet);
+    ScheduleSendQueue();
+}
+
+void WorldSocket::SendPackets(std::vector<SharedPacketPtr> const& packets)
+{
+    if (!IsOpen())
+        return;
+
+    for (SharedPacketPtr const& packet : packets)
+    {
+        if (sPacketLog->CanLogPacket())
+            sPacketLog->LogPacket(packet->GetPacket(), SERVER_TO_CLIENT, GetRemoteIpAddress(), GetRemotePort(), GetConnectionType());
+
+        _sendQueue.add(packet);
+    }
+
+    ScheduleSendQueue();
+}
+
+void WorldSocket::ScheduleSendQueue()
+{
+#ifndef TC_SOCKET_USE_IOCP
+    // polled writes pick the queue up on the next network thread tick
+    if (!sSocketWriteStats.IsEventDriven())
+        return;
+#endif
+
+    if (_sendQueueScheduled.exchange(true))
+        return;
+
+    io_service().post(std::bind(&WorldSocket::ProcessSendQueue, shared_from_this()));
+}
+
+void WorldSocket::ProcessSendQueue()
+{
+    _sendQueueScheduled = false;
 
     std::unique_lock<std::mutex> guard(_writeLock);
 
 #ifndef TC_SOCKET_USE_IOCP
-    if (_writeQueue.empty() && _writeBuffer.GetRemainingSpace() >= sizeOfHeader + packetSize)
-        WritePacketToBuffer(packet, _writeBuffer);
-    else
+    bool writeBufferUsed = false;
 #endif
+
+    SharedPacketPtr packet;
+    while (_sendQueue.next(packet))
     {
-        MessageBuffer buffer(sizeOfHeader + packetSize);
-        WritePacketToBuffer(packet, buffer);
-        QueuePacket(std::move(buffer), guard);
+        uint32 packetSize = GetWrittenPacketSize(*packet);
+
+#ifndef TC_SOCKET_USE_IOCP
+        if (_writeQueue.empty() && _writeBuffer.GetRemainingSpace() >= packetSize)
+        {
+            WritePacketToBuffer(*packet, _writeBuffer);
+            writeBufferUsed = true;
+        }
+        else
+#endif
+        {
+            MessageBuffer buffer(packetSize);
+            WritePacketToBuffer(*packet, buffer);
+            QueuePacket(std::move(buffer), guard);
+        }
     }
+
+#ifndef TC_SOCKET_USE_IOCP
+    if (writeBufferUsed)
+        ScheduleWrite(guard);
+#endif
 }
 
-void WorldSocket::WritePacketToBuffer(WorldPacket const& packet, MessageBuffer& buffer)
+uint32 WorldSocket::GetWrittenPacketSize(SharedPacket const& packet) const
 {
+    uint32 packetSize = packet.GetPacket().size();
+    if (packetSize > MinSizeForCompression && _authCrypt.IsInitialized())
+    {
+        if (packet.IsBroadcast() && !packet.GetCompressed().empty())
+            packetSize = packet.GetCompressed().size() + sizeof(CompressedWorldPacket);
+        else
+            packetSize = compressBound(packetSize) + sizeof(CompressedWorldPacket);
+    }
+
+    return SizeOfServerHeader[_authCrypt.IsInitialized()] + packetSize;
+}
+
+void WorldSocket::WritePacketToBuffer(SharedPacket const& sharedPacket, MessageBuffer& buffer)
+{
+    WorldPacket const& packet = sharedPacket.GetPacket();
     ServerPktHeader header;
     uint32 sizeOfHeader = SizeOfServerHeader[_authCrypt.IsInitialized()];
     uint32 opcode = packet.GetOpcode();
@@ -462,18 +573,34 @@ void WorldSocket::WritePacketToBuffer(WorldPacket const& packet, MessageBuffer&
     {
         CompressedWorldPacket cmp;
         cmp.UncompressedSize = packetSize + 4;
-        cmp.UncompressedAdler = adler32(adler32(0x9827D8F1, (Bytef*)&opcode, 4), packet.contents(), packetSize);
 
         // Reserve space for compression info - uncompressed size and checksums
         uint8* compressionInfo = buffer.GetWritePointer();
         buffer.WriteCompleted(sizeof(CompressedWorldPacket));
 
-        uint32 compressedSize = CompressPacket(buffer.GetWritePointer(), packet);
+        uint32 compressedSize;
+        if (sharedPacket.IsBroadcast() && !sharedPacket.GetCompressed().empty())
+        {
+            // compressed once for every receiver, only the header below is ours
+            std::vector<uint8> const& compressed = sharedPacket.GetCompressed();
+            compressedSize = compressed.size();
+            cmp.UncompressedAdler = sharedPacket.GetUncompressedAdler();
+            cmp.CompressedAdler = sharedPacket.GetCompressedAdler();
+            buffer.Write(compressed.data(), compressedSize);
+
+            AppendToCompressionWindow(packet);
+        }
+        else
+        {
+            cmp.UncompressedAdler = adler32(adler32(0x9827D8F1, (Bytef*)&opcode, 4), packet.contents(), packetSize);
 
-        cmp.CompressedAdler = adler32(0x9827D8F1, buffer.GetWritePointer(), compressedSize);
+            compressedSize = CompressPacket(buffer.GetWritePointer(), packet);
+
+            cmp.CompressedAdler = adler32(0x9827D8F1, buffer.GetWritePointer(), compressedSize);
+            buffer.WriteCompleted(compressedSize);
+        }
 
         memcpy(compressionInfo, &cmp, sizeof(CompressedWorldPacket));
-        buffer.WriteCompleted(compressedSize);
         packetSize = compressedSize + sizeof(CompressedWorldPacket);
 
         opcode = SMSG_COMPRESSED_PACKET;
@@ -503,6 +630,13 @@ uint32 WorldSocket::CompressPacket(uint8* buffer, WorldPacket const& packet)
 
     _compressionStream->next_out = buffer;
     _compressionStream->avail_out = bufferSize;
+
+    int32 level = GetCompressionLevel(packet);
+
+    // the stream was sync flushed after the previous packet, switching the level emits nothing
+    if (level != _compressionLevel && deflateParams(_compressionStream, level, Z_DEFAULT_STRATEGY) == Z_OK)
+        _compressionLevel = level;
+
     _compressionStream->next_in = (Bytef*)&opcode;
     _compressionStream->avail_in = sizeof(uint32);
 
@@ -526,6 +660,30 @@ uint32 WorldSocket::CompressPacket(uint8* buffer, WorldPacket const& packet)
     return bufferSize - _compressionStream->avail_out;
 }
 
+int32 WorldSocket::GetCompressionLevel(WorldPacket const& packet)
+{
+    // large bursts, object updates on login or zone in above all, favour speed over ratio
+    if (uint32 fastMinSize = sWorld->getIntConfig(CONFIG_COMPRESSION_FAST_MIN_SIZE))
+        if (packet.size() >= fastMinSize || packet.GetOpcode() == SMSG_UPDATE_OBJECT)
+            return Z_BEST_SPEED;
+
+    return sWorld->getIntConfig(CONFIG_COMPRESSION);
+}
+
+void WorldSocket::AppendToCompressionWindow(WorldPacket const& packet)
+{
+    // the client inflated the shared blocks with its connection stream, so its window now ends with this packet.
+    // Ours has to as well or the distances of our next back references would point at the wrong bytes.
+    // Raw streams take a dictionary after any flush, and zlib appends it to the current window.
+    uint32 opcode = packet.GetOpcode();
+    if (deflateSetDictionary(_compressionStream, (Bytef*)&opcode, sizeof(opcode)) == Z_OK &&
+        deflateSetDictionary(_compressionStream, packet.contents(), packet.size()) == Z_OK)
+        return;
+
+    // no back reference can cross a reset, at the cost of the history of the stream
+    deflateReset(_compressionStream);
+}
+
 struct AccountInfo
 {
     struct
@@ -629,6 +787,9 @@ void WorldSocket::HandleAuthSessionCallback(std::shared_ptr<WorldPackets::Auth::
     LoginDatabase.Execute(stmt);
     // This also allows to check for possible "hack" attempts on account
 
+    // packets queued so far still go out unencrypted
+    ProcessSendQueue();
+
     // even if auth credentials are bad, try using the session key we have - client cannot read auth response error without it
     _authCrypt.Init(&account.Game.SessionKey);
 
@@ -819,6 +980,7 @@ void WorldSocket::HandleAuthContinuedSessionCallback(std::shared_ptr<WorldPacket
     BigNumber k;
     k.SetHexStr(fields[1].GetCString());
 
+    ProcessSendQueue();
     _authCrypt.Init(&k, _encryptSeed.AsByteArray().get(), _decryptSeed.AsByteArray().get());
 
     SHA1Hash sha;
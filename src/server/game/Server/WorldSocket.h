@@ -20,9 +20,12 @@
 #define __WORLDSOCKET_H__
 
 #include "Common.h"
+#include "LockedQueue.h"
 #include "WorldPacketCrypt.h"
 #include "ServerPktHeader.h"
+#include "SharedPacket.h"
 #include "Socket.h"
+#include "SPSCQueue.h"
 #include "Util.h"
 #include "WorldPacket.h"
 #include "WorldSession.h"
@@ -66,6 +69,12 @@ union ClientPktHeader
 
 #pragma pack(pop)
 
+// packets read but not yet handled by the session, a client this far behind is disconnected
+#define WORLD_SOCKET_RECV_QUEUE_SIZE 1024
+// handled packets kept for reuse, storage above the limit is freed instead
+#define WORLD_SOCKET_PACKET_POOL_SIZE 32
+#define WORLD_SOCKET_MAX_POOLED_STORAGE 4096
+
 class WorldSocket : public Socket<WorldSocket>
 {
     static std::string const ServerConnectionInitialize;
@@ -85,9 +94,19 @@ public:
     bool Update() override;
 
     void SendPacket(WorldPacket const& packet);
+    void SendSharedPacket(SharedPacketPtr const& packet);
+    void SendPackets(std::vector<SharedPacketPtr> const& packets);
+
+    /// zlib level for the packet, Compression unless it is big enough to favour speed
+    static int32 GetCompressionLevel(WorldPacket const& packet);
 
     ConnectionType GetConnectionType() const { return _type; }
 
+    /// session side of the receive queue, only the thread updating the session may call these
+    bool PeekReceivedPacket(WorldPacket*& packet) const { return _recvQueue.Peek(packet); }
+    void PopReceivedPacket() { _recvQueue.Pop(); }
+    void RecyclePacket(WorldPacket* packet);
+
     void SendAuthResponseError(uint8 code);
     void SetWorldSession(WorldSession* session);
 
@@ -112,8 +131,14 @@ private:
     void LogOpcodeText(OpcodeClient opcode, std::unique_lock<std::mutex> const& guard) const;
     /// sends and logs network.opcode without accessing WorldSession
     void SendPacketAndLogOpcode(WorldPacket const& packet);
-    void WritePacketToBuffer(WorldPacket const& packet, MessageBuffer& buffer);
+    /// compresses, encrypts and frames the packets queued by SendPacket(s), runs on the network side only
+    void ProcessSendQueue();
+    void ScheduleSendQueue();
+    uint32 GetWrittenPacketSize(SharedPacket const& packet) const;
+    void WritePacketToBuffer(SharedPacket const& packet, MessageBuffer& buffer);
     uint32 CompressPacket(uint8* buffer, WorldPacket const& packet);
+    /// makes the window of the connection stream end with a packet compressed outside of it, as the client's does
+    void AppendToCompressionWindow(WorldPacket const& packet);
 
     void HandleSendAuthSession();
     void HandleAuthSession(std::shared_ptr<WorldPackets::Auth::AuthSession> authSession);
@@ -145,6 +170,13 @@ private:
     MessageBuffer _packetBuffer;
 
     z_stream_s* _compressionStream;
+    int32 _compressionLevel;                                // level the deflate stream is set to
+
+    SPSCQueue<WorldPacket*, WORLD_SOCKET_RECV_QUEUE_SIZE> _recvQueue;       // read here, handled by the session
+    SPSCQueue<WorldPacket*, WORLD_SOCKET_PACKET_POOL_SIZE> _packetPool;     // handled by the session, reused here
+
+    LockedQueue<SharedPacketPtr> _sendQueue;                // raw packets from the sending threads
+    std::atomic<bool> _sendQueueScheduled;
 
     bool _initialized;
 
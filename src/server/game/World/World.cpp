@@ -51,6 +51,7 @@
 #include "MiscPackets.h"
 #include "MMapFactory.h"
 #include "ObjectMgr.h"
+#include "OpcodeStats.h"
 #include "OutdoorPvPMgr.h"
 #include "Player.h"
 #include "PoolMgr.h"
@@ -623,6 +624,14 @@ void World::LoadConfigSettings(bool reload)
         TC_LOG_ERROR("server.loading", "Compression level (%i) must be in range 1..9. Using default compression level (1).", m_int_configs[CONFIG_COMPRESSION]);
         m_int_configs[CONFIG_COMPRESSION] = 1;
     }
+    m_int_configs[CONFIG_COMPRESSION_FAST_MIN_SIZE] = sConfigMgr->GetIntDefault("Compression.FastMinSize", 16384);
+    m_bool_configs[CONFIG_OPCODE_STATS] = sConfigMgr->GetBoolDefault("OpcodeStats.Enable", true);
+    m_int_configs[CONFIG_OPCODE_STATS_DUMP_INTERVAL] = sConfigMgr->GetIntDefault("OpcodeStats.DumpInterval", 0);
+    if (reload)
+    {
+        m_timers[WUPDATE_OPCODE_STATS].SetInterval(m_int_configs[CONFIG_OPCODE_STATS_DUMP_INTERVAL] * IN_MILLISECONDS);
+        m_timers[WUPDATE_OPCODE_STATS].Reset();
+    }
     m_bool_configs[CONFIG_ADDON_CHANNEL] = sConfigMgr->GetBoolDefault("AddonChannel", true);
     m_bool_configs[CONFIG_CLEAN_CHARACTER_DB] = sConfigMgr->GetBoolDefault("CleanCharacterDB", false);
     m_int_configs[CONFIG_PERSISTENT_CHARACTER_CLEAN_FLAGS] = sConfigMgr->GetIntDefault("PersistentCharacterCleanFlags", 0);
@@ -938,6 +947,7 @@ void World::LoadConfigSettings(bool reload)
     m_bool_configs[CONFIG_CAST_UNSTUCK] = sConfigMgr->GetBoolDefault("CastUnstuck", true);
     m_int_configs[CONFIG_INSTANCE_RESET_TIME_HOUR]  = sConfigMgr->GetIntDefault("Instance.ResetTimeHour", 4);
     m_int_configs[CONFIG_INSTANCE_UNLOAD_DELAY] = sConfigMgr->GetIntDefault("Instance.UnloadDelay", 30 * MINUTE * IN_MILLISECONDS);
+    m_int_configs[CONFIG_INSTANCE_MAP_POOL_SIZE] = sConfigMgr->GetIntDefault("Instance.MapPoolSize", 32);
 
     m_int_configs[CONFIG_MAX_PRIMARY_TRADE_SKILL] = sConfigMgr->GetIntDefault("MaxPrimaryTradeSkill", 2);
     m_int_configs[CONFIG_MIN_PETITION_SIGNS] = sConfigMgr->GetIntDefault("MinPetitionSigns", 4);
@@ -1141,6 +1151,7 @@ void World::LoadConfigSettings(bool reload)
     m_bool_configs[CONFIG_OFFHAND_CHECK_AT_SPELL_UNLEARN]            = sConfigMgr->GetBoolDefault("OffhandCheckAtSpellUnlearn", true);
 
     m_int_configs[CONFIG_CREATURE_PICKPOCKET_REFILL] = sConfigMgr->GetIntDefault("Creature.PickPocketRefillDelay", 10 * MINUTE);
+    m_bool_configs[CONFIG_CREATURE_HIBERNATION] = sConfigMgr->GetBoolDefault("Creature.Hibernation", false);
 
     if (int32 clientCacheId = sConfigMgr->GetIntDefault("ClientCacheVersion", 0))
     {
@@ -1273,6 +1284,8 @@ void World::LoadConfigSettings(bool reload)
     TC_LOG_INFO("server.loading", "VMap support included. LineOfSight: %i, getHeight: %i, indoorCheck: %i", enableLOS, enableHeight, enableIndoor);
     TC_LOG_INFO("server.loading", "VMap data directory is: %svmaps", m_dataPath.c_str());
 
+    m_bool_configs[CONFIG_MAP_FILES_MEMORY_MAPPED] = sConfigMgr->GetBoolDefault("map.memoryMapped", true);
+
     m_int_configs[CONFIG_MAX_WHO] = sConfigMgr->GetIntDefault("MaxWhoListReturns", 49);
     m_bool_configs[CONFIG_START_ALL_SPELLS] = sConfigMgr->GetBoolDefault("PlayerStart.AllSpells", false);
     if (m_bool_configs[CONFIG_START_ALL_SPELLS])
@@ -1298,6 +1311,17 @@ void World::LoadConfigSettings(bool reload)
     m_int_configs[CONFIG_INTERVAL_LOG_UPDATE] = sConfigMgr->GetIntDefault("RecordUpdateTimeDiffInterval", 60000);
     m_int_configs[CONFIG_MIN_LOG_UPDATE] = sConfigMgr->GetIntDefault("MinRecordUpdateTimeDiff", 100);
     m_int_configs[CONFIG_NUMTHREADS] = sConfigMgr->GetIntDefault("MapUpdate.Threads", 1);
+    m_int_configs[CONFIG_MAP_UPDATE_REGIONS_MIN_PLAYERS] = sConfigMgr->GetIntDefault("MapUpdate.Regions.MinPlayers", 0);
+    m_int_configs[CONFIG_MAP_UPDATE_INTERVAL_IDLE] = sConfigMgr->GetIntDefault("MapUpdate.IdleInterval", 1000);
+    m_int_configs[CONFIG_MAP_UPDATE_INTERVAL_AFK] = sConfigMgr->GetIntDefault("MapUpdate.AfkInterval", 400);
+    m_int_configs[CONFIG_VISIBILITY_LOD_DISTANCE] = sConfigMgr->GetIntDefault("Visibility.LOD.Distance", 0);
+    if (m_int_configs[CONFIG_VISIBILITY_LOD_DISTANCE] > 100)
+    {
+        TC_LOG_ERROR("server.loading", "Visibility.LOD.Distance (%u) must be in range 0..100. Set to 0.", m_int_configs[CONFIG_VISIBILITY_LOD_DISTANCE]);
+        m_int_configs[CONFIG_VISIBILITY_LOD_DISTANCE] = 0;
+    }
+    m_int_configs[CONFIG_VISIBILITY_LOD_INTERVAL] = sConfigMgr->GetIntDefault("Visibility.LOD.Interval", 3);
+    m_int_configs[CONFIG_GRID_PREFETCH_THREADS] = sConfigMgr->GetIntDefault("GridPrefetch.Threads", 1);
     m_int_configs[CONFIG_MAX_RESULTS_LOOKUP_COMMANDS] = sConfigMgr->GetIntDefault("Command.LookupMaxResults", 0);
 
     // Warden
@@ -1944,6 +1968,8 @@ void World::SetInitialWorldSettings()
 
     m_timers[WUPDATE_GUILDSAVE].SetInterval(getIntConfig(CONFIG_GUILD_SAVE_INTERVAL) * MINUTE * IN_MILLISECONDS);
 
+    m_timers[WUPDATE_OPCODE_STATS].SetInterval(getIntConfig(CONFIG_OPCODE_STATS_DUMP_INTERVAL) * IN_MILLISECONDS);
+
     //to set mailtimer to return mails every day between 4 and 5 am
     //mailtimer is increased when updating auctions
     //one second is 1000 -(tested on win system)
@@ -2290,6 +2316,13 @@ void World::Update(uint32 diff)
         m_timers[WUPDATE_EVENTS].Reset();
     }
 
+    ///- Append the opcode handler statistics of the last interval to their dump file
+    if (getIntConfig(CONFIG_OPCODE_STATS_DUMP_INTERVAL) && m_timers[WUPDATE_OPCODE_STATS].Passed())
+    {
+        m_timers[WUPDATE_OPCODE_STATS].Reset();
+        sOpcodeStats.Dump(sConfigMgr->GetStringDefault("OpcodeStats.DumpFile", "OpcodeStats.log"));
+    }
+
     ///- Ping to keep MySQL connections alive
     if (m_timers[WUPDATE_PINGDB].Passed())
     {
@@ -2326,6 +2359,7 @@ void World::ForceGameEventUpdate()
 /// Send a packet to all players (except self if mentioned)
 void World::SendGlobalMessage(WorldPacket const* packet, WorldSession* self, uint32 team)
 {
+    SharedPacketPtr sharedPacket = std::make_shared<SharedPacket>(*packet);
     SessionMap::const_iterator itr;
     for (itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
     {
@@ -2335,7 +2369,7 @@ void World::SendGlobalMessage(WorldPacket const* packet, WorldSession* self, uin
             itr->second != self &&
             (team == 0 || itr->second->GetPlayer()->GetTeam() == team))
         {
-            itr->second->SendPacket(packet);
+            itr->second->SendSharedPacket(sharedPacket);
         }
     }
 }
@@ -2343,6 +2377,7 @@ void World::SendGlobalMessage(WorldPacket const* packet, WorldSession* self, uin
 /// Send a packet to all GMs (except self if mentioned)
 void World::SendGlobalGMMessage(WorldPacket const* packet, WorldSession* self, uint32 team)
 {
+    SharedPacketPtr sharedPacket = std::make_shared<SharedPacket>(*packet);
     for (SessionMap::const_iterator itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
     {
         // check if session and can receive global GM Messages and its not self
@@ -2357,7 +2392,7 @@ void World::SendGlobalGMMessage(WorldPacket const* packet, WorldSession* self, u
 
         // Send only to same team, if team is given
         if (!team || player->GetTeam() == team)
-            session->SendPacket(packet);
+            session->SendSharedPacket(sharedPacket);
     }
 }
 
@@ -2476,6 +2511,7 @@ void World::SendGlobalText(const char* text, WorldSession* self)
 bool World::SendZoneMessage(uint32 zone, WorldPacket const* packet, WorldSession* self, uint32 team)
 {
     bool foundPlayerToSend = false;
+    SharedPacketPtr sharedPacket = std::make_shared<SharedPacket>(*packet);
     SessionMap::const_iterator itr;
 
     for (itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
@@ -2487,7 +2523,7 @@ bool World::SendZoneMessage(uint32 zone, WorldPacket const* packet, WorldSession
             itr->second != self &&
             (team == 0 || itr->second->GetPlayer()->GetTeam() == team))
         {
-            itr->second->SendPacket(packet);
+            itr->second->SendSharedPacket(sharedPacket);
             foundPlayerToSend = true;
         }
     }
@@ -90,6 +90,7 @@ enum WorldTimers
     WUPDATE_AHBOT,
     WUPDATE_PINGDB,
     WUPDATE_GUILDSAVE,
+    WUPDATE_OPCODE_STATS,
     WUPDATE_COUNT
 };
 
@@ -178,6 +179,9 @@ enum WorldBoolConfigs
     CONFIG_FEATURE_SYSTEM_CHARACTER_UNDELETE_ENABLED,
     CONFIG_RESET_DUEL_COOLDOWNS,
     CONFIG_RESET_DUEL_HEALTH_MANA,
+    CONFIG_MAP_FILES_MEMORY_MAPPED,
+    CONFIG_CREATURE_HIBERNATION,
+    CONFIG_OPCODE_STATS,
     BOOL_CONFIG_VALUE_COUNT
 };
 
@@ -203,6 +207,7 @@ enum WorldFloatConfigs
 enum WorldIntConfigs
 {
     CONFIG_COMPRESSION = 0,
+    CONFIG_COMPRESSION_FAST_MIN_SIZE,
     CONFIG_INTERVAL_SAVE,
     CONFIG_INTERVAL_GRIDCLEAN,
     CONFIG_INTERVAL_MAPUPDATE,
@@ -249,6 +254,7 @@ enum WorldIntConfigs
     CONFIG_MAX_RECRUIT_A_FRIEND_BONUS_PLAYER_LEVEL_DIFFERENCE,
     CONFIG_INSTANCE_RESET_TIME_HOUR,
     CONFIG_INSTANCE_UNLOAD_DELAY,
+    CONFIG_INSTANCE_MAP_POOL_SIZE,
     CONFIG_MAX_PRIMARY_TRADE_SKILL,
     CONFIG_MIN_PETITION_SIGNS,
     CONFIG_GM_LOGIN_STATE,
@@ -316,6 +322,12 @@ enum WorldIntConfigs
     CONFIG_ENABLE_SINFO_LOGIN,
     CONFIG_PLAYER_ALLOW_COMMANDS,
     CONFIG_NUMTHREADS,
+    CONFIG_MAP_UPDATE_REGIONS_MIN_PLAYERS,
+    CONFIG_MAP_UPDATE_INTERVAL_IDLE,
+    CONFIG_MAP_UPDATE_INTERVAL_AFK,
+    CONFIG_VISIBILITY_LOD_DISTANCE,
+    CONFIG_VISIBILITY_LOD_INTERVAL,
+    CONFIG_GRID_PREFETCH_THREADS,
     CONFIG_LOGDB_CLEARINTERVAL,
     CONFIG_LOGDB_CLEARTIME,
     CONFIG_CLIENTCACHE_VERSION,
@@ -370,6 +382,7 @@ enum WorldIntConfigs
     CONFIG_CHARTER_COST_ARENA_5v5,
     CONFIG_NO_GRAY_AGGRO_ABOVE,
     CONFIG_NO_GRAY_AGGRO_BELOW,
+    CONFIG_OPCODE_STATS_DUMP_INTERVAL,
     INT_CONFIG_VALUE_COUNT
 };
 
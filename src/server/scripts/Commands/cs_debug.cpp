@@ -35,6 +35,7 @@ EndScriptData */
 #include "Language.h"
 #include "MapManager.h"
 #include "MovementPackets.h"
+#include "OpcodeStats.h"
 #include "SpellPackets.h"
 #include "ScenePackets.h"
 
@@ -98,6 +99,8 @@ public:
             { "transport",     rbac::RBAC_PERM_COMMAND_DEBUG_TRANSPORT,     false, &HandleDebugTransportCommand,        "" },
             { "loadcells",     rbac::RBAC_PERM_COMMAND_DEBUG_LOADCELLS,     false, &HandleDebugLoadCellsCommand,        "",},
             { "phase",         rbac::RBAC_PERM_COMMAND_DEBUG_PHASE,         false, &HandleDebugPhaseCommand,            "" },
+            { "mapupdates",    rbac::RBAC_PERM_COMMAND_DEBUG_MAPUPDATES,    true,  &HandleDebugMapUpdatesCommand,       "" },
+            { "opcodestats",   rbac::RBAC_PERM_COMMAND_DEBUG_OPCODESTATS,   true,  &HandleDebugOpcodeStatsCommand,      "" },
         };
         static std::vector<ChatCommand> commandTable =
         {
@@ -1419,6 +1422,60 @@ public:
         return true;
     }
 
+    static bool HandleDebugMapUpdatesCommand(ChatHandler* handler, char const* args)
+    {
+        auto printMap = [handler](Map* map)
+        {
+            handler->PSendSysMessage("Map %u (instance %u): %u players, update interval %u ms, update cost %u us",
+                map->GetId(), map->GetInstanceId(), map->GetPlayers().getSize(), std::max(map->GetUpdateInterval(), sWorld->getIntConfig(CONFIG_INTERVAL_MAPUPDATE)), map->GetUpdateCost());
+        };
+
+        if (*args)
+            sMapMgr->DoForAllMapsWithMapId(uint32(atoi(args)), printMap);
+        else
+            sMapMgr->DoForAllMaps(printMap);
+
+        return true;
+    }
+
+    static bool HandleDebugOpcodeStatsCommand(ChatHandler* handler, char const* args)
+    {
+        if (*args && !strcmp(args, "reset"))
+        {
+            sOpcodeStats.Reset();
+            handler->SendSysMessage("Opcode statistics reset.");
+            return true;
+        }
+
+        uint32 count = *args ? uint32(atoi(args)) : 10;
+
+        std::vector<OpcodeStats::HandlerSummary> handlers = sOpcodeStats.GetHandlerSummaries();
+        OpcodeStats::ProcessingSummary totals[PROCESS_THREADSAFE + 1];
+        OpcodeStats::SumByProcessing(handlers, totals);
+
+        handler->PSendSysMessage("Opcode statistics of the last %u seconds:", uint32(time(NULL) - sOpcodeStats.GetResetTime()));
+        for (uint8 i = PROCESS_INPLACE; i <= PROCESS_THREADSAFE; ++i)
+            handler->PSendSysMessage("%s: " UI64FMTD " packets, " UI64FMTD " bytes in, " UI64FMTD " us",
+                OpcodeStats::GetProcessingName(PacketProcessing(i)), totals[i].Count, totals[i].Bytes, totals[i].TotalTime);
+
+        handler->PSendSysMessage("Top %u handlers by total time:", count);
+        for (uint32 i = 0; i < count && i < handlers.size(); ++i)
+        {
+            OpcodeStats::HandlerSummary const& summary = handlers[i];
+            handler->PSendSysMessage("%s %s: " UI64FMTD " packets, " UI64FMTD " bytes in, " UI64FMTD " us, p50 < " UI64FMTD " us, p99 < " UI64FMTD " us, max %u us",
+                GetOpcodeNameForLogging(summary.Opcode).c_str(), OpcodeStats::GetProcessingName(summary.Processing),
+                summary.Count, summary.Bytes, summary.TotalTime, summary.P50, summary.P99, summary.MaxTime);
+        }
+
+        std::vector<OpcodeStats::SentSummary> sent = sOpcodeStats.GetSentSummaries();
+        handler->PSendSysMessage("Top %u sent opcodes by bytes:", count);
+        for (uint32 i = 0; i < count && i < sent.size(); ++i)
+            handler->PSendSysMessage("%s: " UI64FMTD " packets, " UI64FMTD " bytes out",
+                GetOpcodeNameForLogging(sent[i].Opcode).c_str(), sent[i].Count, sent[i].Bytes);
+
+        return true;
+    }
+
     static bool HandleDebugPhaseCommand(ChatHandler* handler, char const* /*args*/)
     {
         Unit* target = handler->getSelectedUnit();
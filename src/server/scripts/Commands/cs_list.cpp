@@ -26,6 +26,7 @@ EndScriptData */
 #include "Chat.h"
 #include "SpellAuraEffects.h"
 #include "Language.h"
+#include "Map.h"
 #include "ObjectAccessor.h"
 #include "ObjectMgr.h"
 #include "Player.h"
@@ -45,6 +46,7 @@ public:
             { "object",   rbac::RBAC_PERM_COMMAND_LIST_OBJECT,   true, &HandleListObjectCommand,   "" },
             { "auras",    rbac::RBAC_PERM_COMMAND_LIST_AURAS,   false, &HandleListAurasCommand,    "" },
             { "mail",     rbac::RBAC_PERM_COMMAND_LIST_MAIL,     true, &HandleListMailCommand,     "" },
+            { "respawns", rbac::RBAC_PERM_COMMAND_LIST_RESPAWNS, false, &HandleListRespawnsCommand, "" },
         };
         static std::vector<ChatCommand> commandTable =
         {
@@ -576,6 +578,27 @@ public:
             handler->PSendSysMessage(LANG_LIST_MAIL_NOT_FOUND);
         return true;
     }
+
+    static bool HandleListRespawnsCommand(ChatHandler* handler, char const* args)
+    {
+        Player* player = handler->GetSession()->GetPlayer();
+        uint32 zoneId = *args ? uint32(atoi(args)) : player->GetZoneId();
+
+        std::vector<Map::PendingRespawn> respawns;
+        player->GetMap()->GetPendingRespawns(zoneId, respawns);
+
+        time_t now = time(NULL);
+        handler->PSendSysMessage(LANG_LIST_RESPAWNS_HEADER, uint32(respawns.size()), zoneId);
+        for (Map::PendingRespawn const& respawn : respawns)
+        {
+            if (respawn.RespawnTime > now)
+                handler->PSendSysMessage(LANG_LIST_RESPAWNS_ENTRY, respawn.SpawnGuid.ToString().c_str(), secsToTimeString(respawn.RespawnTime - now, true).c_str());
+            else
+                handler->PSendSysMessage(LANG_LIST_RESPAWNS_ENTRY_DUE, respawn.SpawnGuid.ToString().c_str());
+        }
+
+        return true;
+    }
 };
 
 void AddSC_list_commandscript()
@@ -98,6 +98,14 @@ public:
         }
     }
 
+    // Takes over a spare buffer to reuse its allocation, the contents are discarded
+    void Reuse(std::vector<uint8>&& storage)
+    {
+        _wpos = 0;
+        _rpos = 0;
+        _storage = std::move(storage);
+    }
+
     std::vector<uint8>&& Move()
     {
         _wpos = 0;
@@ -21,6 +21,7 @@
 #include "Define.h"
 #include "Errors.h"
 #include "Log.h"
+#include "SocketWriteStats.h"
 #include "Timer.h"
 #include <atomic>
 #include <chrono>
@@ -142,6 +143,8 @@ protected:
                     ++i;
             }
 
+            sSocketWriteStats.LogIfDue();
+
             diff = GetMSTimeDiffToNow(tickStart);
             sleepTime = diff > 10 ? 0 : 10 - diff;
         }
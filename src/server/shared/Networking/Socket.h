@@ -20,10 +20,12 @@
 
 #include "MessageBuffer.h"
 #include "Log.h"
+#include "SocketWriteStats.h"
 #include <atomic>
+#include <chrono>
 #include <vector>
 #include <mutex>
-#include <queue>
+#include <deque>
 #include <memory>
 #include <functional>
 #include <type_traits>
@@ -34,6 +36,7 @@
 using boost::asio::ip::tcp;
 
 #define READ_BLOCK_SIZE 4096
+#define MAX_WRITE_BUFFERS_PER_SEND 64
 #ifdef BOOST_ASIO_HAS_IOCP
 #define TC_SOCKET_USE_IOCP
 #endif
@@ -46,6 +49,9 @@ public:
         _remotePort(_socket.remote_endpoint().port()), _readBuffer(), _closed(false), _closing(false), _isWritingAsync(false)
     {
         _readBuffer.Resize(READ_BLOCK_SIZE);
+#ifndef TC_SOCKET_USE_IOCP
+        _writePending = false;
+#endif
     }
 
     virtual ~Socket()
@@ -100,12 +106,12 @@ public:
 
     void QueuePacket(MessageBuffer&& buffer, std::unique_lock<std::mutex>& guard)
     {
-        _writeQueue.push(std::move(buffer));
+        _writeQueue.push_back(std::move(buffer));
 
 #ifdef TC_SOCKET_USE_IOCP
         AsyncProcessQueue(guard);
 #else
-        (void)guard;
+        ScheduleWrite(guard);
 #endif
     }
 
@@ -163,8 +169,24 @@ protected:
                 GetRemoteIpAddress().to_string().c_str(), err.value(), err.message().c_str());
     }
 
+#ifndef TC_SOCKET_USE_IOCP
+    /// Called with _writeLock held after data was added to _writeBuffer or _writeQueue
+    void ScheduleWrite(std::unique_lock<std::mutex>& guard)
+    {
+        if (!_writePending)
+        {
+            _writePending = true;
+            _writePendingSince = std::chrono::steady_clock::now();
+        }
+
+        // wait for the socket to become writable instead of the next network thread tick
+        if (sSocketWriteStats.IsEventDriven())
+            AsyncProcessQueue(guard);
+    }
+#endif
+
     std::mutex _writeLock;
-    std::queue<MessageBuffer> _writeQueue;
+    std::deque<MessageBuffer> _writeQueue;
 #ifndef TC_SOCKET_USE_IOCP
     MessageBuffer _writeBuffer;
 #endif
@@ -195,7 +217,7 @@ private:
             _isWritingAsync = false;
             _writeQueue.front().ReadCompleted(transferedBytes);
             if (!_writeQueue.front().GetActiveSize())
-                _writeQueue.pop();
+                _writeQueue.pop_front();
 
             if (!_writeQueue.empty())
                 AsyncProcessQueue(deleteGuard);
@@ -212,21 +234,42 @@ private:
     {
         std::unique_lock<std::mutex> guard(_writeLock);
         _isWritingAsync = false;
-        WriteHandler(guard);
+        for (; WriteHandler(guard);)
+            ;
     }
 
+    /// Sends _writeBuffer and the queued messages with one scatter-gather write, returns true if more is left to send right away
     bool WriteHandler(std::unique_lock<std::mutex>& guard)
     {
         if (!IsOpen())
             return false;
 
-        std::size_t bytesToSend = _writeBuffer.GetActiveSize();
+        while (!_writeQueue.empty() && !_writeQueue.front().GetActiveSize())
+            _writeQueue.pop_front();
 
-        if (bytesToSend == 0)
-            return HandleQueue(guard);
+        _sendBuffers.clear();
+        if (_writeBuffer.GetActiveSize())
+            _sendBuffers.push_back(boost::asio::buffer(_writeBuffer.GetReadPointer(), _writeBuffer.GetActiveSize()));
+
+        for (MessageBuffer& queuedMessage : _writeQueue)
+        {
+            if (_sendBuffers.size() >= MAX_WRITE_BUFFERS_PER_SEND)
+                break;
+
+            if (queuedMessage.GetActiveSize())
+                _sendBuffers.push_back(boost::asio::buffer(queuedMessage.GetReadPointer(), queuedMessage.GetActiveSize()));
+        }
+
+        if (_sendBuffers.empty())
+        {
+            WriteFlushed();
+            return false;
+        }
+
+        std::size_t bytesToSend = boost::asio::buffer_size(_sendBuffers);
 
         boost::system::error_code error;
-        std::size_t bytesWritten = _socket.write_some(boost::asio::buffer(_writeBuffer.GetReadPointer(), bytesToSend), error);
+        std::size_t bytesWritten = _socket.write_some(_sendBuffers, error);
 
         if (error)
         {
@@ -237,52 +280,55 @@ private:
         }
         else if (bytesWritten == 0)
             return false;
-        else if (bytesWritten < bytesToSend)
-        {
-            _writeBuffer.ReadCompleted(bytesWritten);
-            _writeBuffer.Normalize();
+
+        WriteCompleted(bytesWritten);
+
+        // kernel buffer is full, continue once the socket is writable again
+        if (bytesWritten < bytesToSend)
             return AsyncProcessQueue(guard);
-        }
 
-        // now bytesWritten == bytesToSend
-        _writeBuffer.Reset();
+        if (_writeBuffer.GetActiveSize() || !_writeQueue.empty())
+            return true;
 
-        return HandleQueue(guard);
+        WriteFlushed();
+        return false;
     }
 
-    bool HandleQueue(std::unique_lock<std::mutex>& guard)
+    void WriteCompleted(std::size_t bytesWritten)
     {
-        if (_writeQueue.empty())
-            return false;
-
-        MessageBuffer& queuedMessage = _writeQueue.front();
-
-        std::size_t bytesToSend = queuedMessage.GetActiveSize();
-
-        boost::system::error_code error;
-        std::size_t bytesSent = _socket.write_some(boost::asio::buffer(queuedMessage.GetReadPointer(), bytesToSend), error);
-
-        if (error)
+        if (std::size_t bufferBytes = _writeBuffer.GetActiveSize())
         {
-            if (error == boost::asio::error::would_block || error == boost::asio::error::try_again)
-                return AsyncProcessQueue(guard);
-
-            _writeQueue.pop();
-            return false;
+            if (bytesWritten >= bufferBytes)
+            {
+                _writeBuffer.Reset();
+                bytesWritten -= bufferBytes;
+            }
+            else
+            {
+                _writeBuffer.ReadCompleted(bytesWritten);
+                _writeBuffer.Normalize();
+                return;
+            }
         }
-        else if (bytesSent == 0)
-        {
-            _writeQueue.pop();
-            return false;
-        }
-        else if (bytesSent < bytesToSend) // now n > 0
+
+        while (bytesWritten && !_writeQueue.empty())
         {
-            queuedMessage.ReadCompleted(bytesSent);
-            return AsyncProcessQueue(guard);
+            MessageBuffer& queuedMessage = _writeQueue.front();
+            std::size_t messageBytes = std::min(bytesWritten, queuedMessage.GetActiveSize());
+            queuedMessage.ReadCompleted(messageBytes);
+            bytesWritten -= messageBytes;
+            if (!queuedMessage.GetActiveSize())
+                _writeQueue.pop_front();
         }
+    }
 
-        _writeQueue.pop();
-        return !_writeQueue.empty();
+    void WriteFlushed()
+    {
+        if (!_writePending)
+            return;
+
+        _writePending = false;
+        sSocketWriteStats.RecordFlush(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _writePendingSince).count());
     }
 
 #endif
@@ -298,6 +344,12 @@ private:
     std::atomic<bool> _closing;
 
     bool _isWritingAsync;
+
+#ifndef TC_SOCKET_USE_IOCP
+    bool _writePending;                                     // data was queued and not fully handed to the kernel yet
+    std::chrono::steady_clock::time_point _writePendingSince;
+    std::vector<boost::asio::const_buffer> _sendBuffers;
+#endif
 };
 
 #endif // __SOCKET_H__
@@ -46,6 +46,9 @@ public:
             return false;
         }
 
+        sSocketWriteStats.SetEventDriven(sConfigMgr->GetBoolDefault("Network.EventDrivenWrites", true));
+        sSocketWriteStats.SetLogInterval(sConfigMgr->GetIntDefault("Network.WriteLatencyLogInterval", 0));
+
         try
         {
             _acceptor = new AsyncAcceptor(service, bindIp, port);
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SocketWriteStats.h"
+#include "Log.h"
+#include "Timer.h"
+#include <sstream>
+
+void SocketWriteStats::LogIfDue()
+{
+    uint32 interval = _logInterval;
+    if (!interval)
+        return;
+
+    uint32 now = getMSTime();
+    uint32 lastLogTime = _lastLogTime;
+    if (getMSTimeDiff(lastLogTime, now) < interval)
+        return;
+
+    // another network thread logged already
+    if (!_lastLogTime.compare_exchange_strong(lastLogTime, now))
+        return;
+
+    TC_LOG_INFO("network", "Socket write latency (%s): %s", _eventDriven ? "event driven" : "polled", ToString().c_str());
+
+    for (uint32 i = 0; i < SOCKET_WRITE_LATENCY_BUCKETS; ++i)
+        _buckets[i] = 0;
+}
+
+std::string SocketWriteStats::ToString() const
+{
+    uint64 counts[SOCKET_WRITE_LATENCY_BUCKETS];
+    uint64 total = 0;
+    for (uint32 i = 0; i < SOCKET_WRITE_LATENCY_BUCKETS; ++i)
+    {
+        counts[i] = _buckets[i];
+        total += counts[i];
+    }
+
+    std::ostringstream ss;
+    ss << total << " flushes";
+    if (!total)
+        return ss.str();
+
+    // upper bound of the bucket holding the percentile
+    uint64 p50 = 0, p99 = 0, seen = 0;
+    for (uint32 i = 0; i < SOCKET_WRITE_LATENCY_BUCKETS; ++i)
+    {
+        seen += counts[i];
+        if (!p50 && seen * 2 >= total)
+            p50 = UI64LIT(1) << (i + 1);
+        if (!p99 && seen * 100 >= total * 99)
+            p99 = UI64LIT(1) << (i + 1);
+    }
+
+    ss << ", p50 < " << p50 << "us, p99 < " << p99 << "us |";
+    for (uint32 i = 0; i < SOCKET_WRITE_LATENCY_BUCKETS; ++i)
+        if (counts[i])
+            ss << ' ' << (UI64LIT(1) << i) << "us:" << counts[i];
+
+    return ss.str();
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SocketWriteStats_h__
+#define SocketWriteStats_h__
+
+#include "Define.h"
+#include <atomic>
+#include <string>
+
+// bucket i counts flushes that took [2^i, 2^(i+1)) microseconds, the last one everything above
+#define SOCKET_WRITE_LATENCY_BUCKETS 20
+
+/// Time from data being queued on a socket with nothing pending until the kernel accepted all of it
+class SocketWriteStats
+{
+    SocketWriteStats() : _eventDriven(true), _logInterval(0), _lastLogTime(0)
+    {
+        for (uint32 i = 0; i < SOCKET_WRITE_LATENCY_BUCKETS; ++i)
+            _buckets[i] = 0;
+    }
+
+public:
+    static SocketWriteStats& Instance()
+    {
+        static SocketWriteStats instance;
+        return instance;
+    }
+
+    /// Flush as soon as data is queued instead of waiting for the next network thread tick (non IOCP only)
+    bool IsEventDriven() const { return _eventDriven; }
+    void SetEventDriven(bool enable) { _eventDriven = enable; }
+
+    /// Seconds between two histogram log lines, 0 disables
+    void SetLogInterval(uint32 seconds) { _logInterval = seconds * 1000; }
+
+    void RecordFlush(uint64 microseconds)
+    {
+        uint32 bucket = 0;
+        while (microseconds > 1 && bucket < SOCKET_WRITE_LATENCY_BUCKETS - 1)
+        {
+            microseconds >>= 1;
+            ++bucket;
+        }
+
+        ++_buckets[bucket];
+    }
+
+    /// Logs and resets the histogram once per log interval, safe to call from every network thread
+    void LogIfDue();
+
+    std::string ToString() const;
+
+private:
+    std::atomic<bool> _eventDriven;
+    std::atomic<uint32> _logInterval;
+    std::atomic<uint32> _lastLogTime;
+    std::atomic<uint64> _buckets[SOCKET_WRITE_LATENCY_BUCKETS];
+};
+
+#define sSocketWriteStats SocketWriteStats::Instance()
+
+#endif // SocketWriteStats_h__